@@ -0,0 +1,33 @@
+#include <davinci.h>
+using namespace davinci;
+
+class LightingShaderMaterial : public LightingShader
+{
+public:
+	void setLightColor(const fVector3& lightColor) {
+		m_lightColor = lightColor;
+	}
+
+	void setLightDir(const fVector3& lightDir) {
+		m_lightDir = lightDir;
+	}
+
+public:
+	virtual void lightingFunction(int32_t x, int32_t y, const GBufferPixel& pixel, float depth, fVector4& color) const {
+		fVector3 finalColor = fVector3(0.1f, 0.1f, 0.1f);
+
+		//do NdotL lighting for all lights
+		finalColor += (-m_lightDir.dotProduct(pixel.normal) * m_lightColor);
+
+		const fVector3 lit = finalColor.saturate();
+		color = fVector4(lit.x*pixel.albedo.x, lit.y*pixel.albedo.y, lit.z*pixel.albedo.z, pixel.albedo.w);
+	}
+
+private:
+	fVector3 m_lightDir;
+	fVector3 m_lightColor;
+
+public:
+	LightingShaderMaterial() {}
+	~LightingShaderMaterial() {}
+};
@@ -1,8 +1,9 @@
 #include <davinci.h>
+#include <pipe/dv_pipe_static.h>
 using namespace davinci;
 
 template<typename PSIN>
-class PixelShaderMaterial : public PixelShader
+class PixelShaderMaterial : public PixelShaderT<PixelShaderMaterial<PSIN>, PSIN>
 {
 public:
 	TexturePtr sampler;
@@ -10,6 +11,8 @@ public:
 	{
 		fVector3 lightDir;
 		fVector3 lightColor;
+		fVector4 albedo;
+		const ShadowMap* shadowMap;
 	};
 
 	void setLightColor(const fVector3& lightColor) {
@@ -21,15 +24,27 @@ public:
 		m_lightDir = lightDir;
 	}
 
+	//surface color, used by forward, G-buffer and MRT output alike
+	void setAlbedo(const fVector4& albedo) {
+		m_albedo = albedo;
+	}
+
+	//directional light is not shadowed if null
+	void setShadowMap(const ShadowMap* shadowMap) {
+		m_shadowMap = shadowMap;
+	}
+
 public:
 	virtual void preRender(RenderablePtr renderable) const {
 		PSConstantBuffer param;
 		param.lightDir = m_lightDir;
 		param.lightColor = m_lightColor;
+		param.albedo = m_albedo;
+		param.shadowMap = m_shadowMap;
 		renderable->setPSConstantBuffer(0, (const uint8_t*)&param, sizeof(PSConstantBuffer));
 	}
 
-	virtual void psFunction(ConstConstantBufferPtr constantBuffer, const float* input, fVector4& color, float& depth) const {
+	virtual void psFunction(const ConstantBuffer* constantBuffer, const float* input, fVector4& color, float& depth) const {
 		const PSIN* psin = (const PSIN*)(input);
 
 		const PSConstantBuffer* param = (const PSConstantBuffer*)constantBuffer->getBuffer(0);
@@ -37,18 +52,42 @@ public:
 		fVector3 finalColor = fVector3(0.1f, 0.1f, 0.1f);
 
 		//do NdotL lighting for all lights
-		finalColor += (-param->lightDir.dotProduct(psin->normal) * param->lightColor);
+		float shadow = (param->shadowMap != nullptr) ? param->shadowMap->getShadow(psin->pos) : 1.f;
+		finalColor += (-param->lightDir.dotProduct(psin->normal) * shadow * param->lightColor);
 
-		color = fVector4(finalColor.saturate(), 1.f);
+		const fVector3 lit = finalColor.saturate();
+		color = fVector4(lit.x*param->albedo.x, lit.y*param->albedo.y, lit.z*param->albedo.z, param->albedo.w);
 
 		depth = psin->pos.z;
 	}
 
+	//lighting is deferred to LightingShaderMaterial
+	virtual void psGBuffer(const ConstantBuffer* constantBuffer, const float* input, GBufferPixel& pixel, float& depth) const {
+		const PSIN* psin = (const PSIN*)(input);
+		const PSConstantBuffer* param = (const PSConstantBuffer*)constantBuffer->getBuffer(0);
+
+		pixel.normal = psin->normal;
+		pixel.albedo = param->albedo;
+
+		depth = psin->pos.z;
+	}
+
+	//lit color, normal packed to [0, 1] and albedo
+	virtual void psMultiTarget(const ConstantBuffer* constantBuffer, const float* input, fVector4* outputs, float& depth) const {
+		const PSIN* psin = (const PSIN*)(input);
+
+		psFunction(constantBuffer, input, outputs[0], depth);
+		outputs[1] = fVector4(psin->normal*0.5f + fVector3(0.5f, 0.5f, 0.5f), 1.f);
+		outputs[2] = ((const PSConstantBuffer*)constantBuffer->getBuffer(0))->albedo;
+	}
+
 private:
 	fVector3 m_lightDir;
 	fVector3 m_lightColor;
+	fVector4 m_albedo;
+	const ShadowMap* m_shadowMap;
 
 public:
-	PixelShaderMaterial() {}
+	PixelShaderMaterial() : m_albedo(fVector4::WHITE), m_shadowMap(nullptr) {}
 	~PixelShaderMaterial() {}
 };
@@ -1,8 +1,9 @@
 #include <davinci.h>
+#include <pipe/dv_pipe_static.h>
 using namespace davinci;
 
 template<typename PSIN>
-class PixelShaderSolid : public PixelShader
+class PixelShaderSolid : public PixelShaderT<PixelShaderSolid<PSIN>, PSIN>
 {
 public:
 	struct PSConstantBuffer
@@ -17,7 +18,7 @@ public:
 		renderable->setPSConstantBuffer(0, (const uint8_t*)&param, sizeof(PSConstantBuffer));
 	}
 
-	virtual void psFunction(ConstConstantBufferPtr constantBuffer, const float* input, fVector4& color, float& depth) const {
+	virtual void psFunction(const ConstantBuffer* constantBuffer, const float* input, fVector4& color, float& depth) const {
 		const PSIN* psin = (const PSIN*)(input);
 
 		const PSConstantBuffer* param = (const PSConstantBuffer*)constantBuffer->getBuffer(0);
@@ -26,6 +27,13 @@ public:
 		depth = psin->pos.z;
 	}
 
+	virtual bool psConstant(const ConstantBuffer* constantBuffer, fVector4& color) const {
+		const PSConstantBuffer* param = (const PSConstantBuffer*)constantBuffer->getBuffer(0);
+
+		color = fVector4(param->solidColor, 1.f);
+		return true;
+	}
+
 private:
 	fVector3 m_color;
 
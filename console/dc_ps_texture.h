@@ -1,8 +1,9 @@
 #include <davinci.h>
+#include <pipe/dv_pipe_static.h>
 using namespace davinci;
 
 template<typename PSIN>
-class PixelShaderTexture : public PixelShader
+class PixelShaderTexture : public PixelShaderT<PixelShaderTexture<PSIN>, PSIN>
 {
 public:
 	struct PSConstantBuffer
@@ -22,7 +23,7 @@ public:
 		renderable->setPSConstantBuffer(0, (const uint8_t*)&param, sizeof(PSConstantBuffer));
 	}
 
-	virtual void psFunction(ConstConstantBufferPtr constantBuffer, const float* input, fVector4& color, float& depth) const {
+	virtual void psFunction(const ConstantBuffer* constantBuffer, const float* input, fVector4& color, float& depth) const {
 		const PSIN* psin = (const PSIN*)(input);
 		const PSConstantBuffer* param = (const PSConstantBuffer*)constantBuffer->getBuffer(0);
 		const fVector3 meshColor = param->meshColor;
@@ -0,0 +1,56 @@
+#include <davinci.h>
+#include <pipe/dv_pipe_static.h>
+using namespace davinci;
+
+//Lit by point and spot lights of LightGrid, each pixel only loops over lights of its own tile
+template<typename PSIN>
+class PixelShaderTiledLights : public PixelShaderT<PixelShaderTiledLights<PSIN>, PSIN>
+{
+public:
+	struct PSConstantBuffer
+	{
+		const LightGrid* lightGrid;
+	};
+
+	void setLightGrid(const LightGrid* lightGrid) {
+		m_lightGrid = lightGrid;
+	}
+
+public:
+	virtual void preRender(RenderablePtr renderable) const {
+		PSConstantBuffer param;
+		param.lightGrid = m_lightGrid;
+		renderable->setPSConstantBuffer(0, (const uint8_t*)&param, sizeof(PSConstantBuffer));
+	}
+
+	virtual void psFunction(const ConstantBuffer* constantBuffer, const float* input, fVector4& color, float& depth) const {
+		const PSIN* psin = (const PSIN*)(input);
+
+		const PSConstantBuffer* param = (const PSConstantBuffer*)constantBuffer->getBuffer(0);
+		const LightGrid* lightGrid = param->lightGrid;
+
+		fVector3 finalColor = fVector3(0.1f, 0.1f, 0.1f);
+		fVector3 worldPos = lightGrid->getWorldPosition(psin->pos);
+
+		for (uint32_t index : lightGrid->getTileLights(psin->pos)) {
+			const Light& light = lightGrid->getLight(index);
+
+			fVector3 lightDir;
+			float attenuation = light.getAttenuation(worldPos, lightDir);
+			if (attenuation <= 0.f) continue;
+
+			finalColor += (MathUtil::max2(lightDir.dotProduct(psin->normal), 0.f) * attenuation * light.color);
+		}
+
+		color = fVector4(finalColor.saturate(), 1.f);
+
+		depth = psin->pos.z;
+	}
+
+private:
+	const LightGrid* m_lightGrid;
+
+public:
+	PixelShaderTiledLights() : m_lightGrid(nullptr) {}
+	~PixelShaderTiledLights() {}
+};
@@ -25,7 +25,7 @@ bool Sample01::init(void)
 	vsoutDesc.addElement(VertexElementType::VET_POSITION, VET_FLOAT_X3);
 	vsoutDesc.addElement(VertexElementType::VET_NORMAL, VET_FLOAT_X3);
 
-	m_vs = std::make_shared<VSStandard>(vsoutDesc, &m_camera);
+	m_vs = std::make_shared<VSStandard>(vsoutDesc);
 	m_ps = std::make_shared<PSWithDirLight>();
 	
 	m_lightColor[0] = fVector3(0.5f, 0.5f, 0.5f);
@@ -98,11 +98,10 @@ void Sample01::render(int32_t width, int32_t height)
 	m_camera.setClipRange(0.01f, 100.0f, false);
 	m_camera.setAspect(width / (float)height);
 
-	RenderQueue renderQueue;
-	m_scene.render(m_device, m_camera, renderQueue);
+	m_scene.render(m_device, m_camera, m_renderQueue);
 
 	//render!
 	m_renderTarget.init(width, height);
-	renderQueue.process(m_renderTarget);
+	m_renderQueue.process(m_renderTarget);
 }
 
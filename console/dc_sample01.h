@@ -13,6 +13,7 @@ public:
 
 private:
 	RenderDevice m_device;
+	RenderQueue m_renderQueue;
 	Scene  m_scene;
 	VertexShaderPtr m_vs;
 	PixelShaderPtr m_ps;
@@ -25,7 +25,7 @@ bool Sample02::init(void)
 
 	m_texture = AssetUtility::createStandardTexture(&m_device, 256, 256); 
 
-	m_vs = std::make_shared<VSStandard>(vsoutDesc, &m_camera);
+	m_vs = std::make_shared<VSStandard>(vsoutDesc);
 	m_ps = std::make_shared<PSWithTexture>(m_texture);
 
 	//build a scene
@@ -61,10 +61,9 @@ void Sample02::render(int32_t width, int32_t height)
 	m_camera.setClipRange(0.01f, 100.0f, false);
 	m_camera.setAspect(width / (float)height);
 
-	RenderQueue renderQueue;
-	m_scene.render(m_device, m_camera, renderQueue);
+	m_scene.render(m_device, m_camera, m_renderQueue);
 
 	//render!
 	m_renderTarget.init(width, height);
-	renderQueue.process(m_renderTarget);
+	m_renderQueue.process(m_renderTarget);
 }
@@ -2,6 +2,18 @@
 
 #include "dc_vs_standard.h"
 #include "dc_ps_material.h"
+#include "dc_ls_material.h"
+#include "dc_ps_tiled_lights.h"
+
+//#define DEFERRED_SHADING
+//#define VISIBILITY_BUFFER
+//#define Z_PREPASS
+//#define TILED_LIGHTS
+//#define VARIABLE_RATE_SHADING
+//#define ADDITIVE_BLEND
+//#define POST_PROCESS
+//#define COMMAND_LISTS
+//#define INSTANCING
 
 struct VSOUT
 {
@@ -12,6 +24,7 @@ struct VSOUT
 
 typedef VertexShaderStandard<true, false>	VSStandard;
 typedef PixelShaderMaterial<VSOUT>			PSMaterial;
+typedef PixelShaderTiledLights<VSOUT>		PSTiledLights;
 
 //-------------------------------------------------------------------------------------
 bool Sample03::init(void)
@@ -25,11 +38,29 @@ bool Sample03::init(void)
 	vsoutDesc.addElement(VertexElementType::VET_NORMAL, VET_FLOAT_X3);
 	//vsoutDesc.addElement(VertexElementType::VET_TEXCOORD0, VET_FLOAT_X2);
 
-	m_vs = std::make_shared<VSStandard>(vsoutDesc, &m_camera);
+	m_vs = std::make_shared<VSStandard>(vsoutDesc);
+#ifdef TILED_LIGHTS
+	m_ps = std::make_shared<PSTiledLights>();
+	((PSTiledLights*)m_ps.get())->setLightGrid(&m_lightGrid);
+	_createLights(256);
+#else
 	m_ps = std::make_shared<PSMaterial>();
 
 	((PSMaterial*)m_ps.get())->setLightDir(fVector3(-3, -4, 10).normalise());
 	((PSMaterial*)m_ps.get())->setLightColor(fVector3::WHITE);
+	((PSMaterial*)m_ps.get())->setShadowMap(&m_shadowMap);
+#endif
+
+	//two cascades cover the model, the rest of view is not shadowed
+	m_shadowMap.setLightDir(fVector3(-3, -4, 10).normalise());
+	m_shadowMap.setResolution(512);
+	m_shadowMap.setCascadeCounts(2);
+	m_shadowMap.setShadowDistance(20.f);
+	m_shadowMap.setFilter(ShadowMap::SF_PCF_3X3);
+
+	m_ls = std::make_shared<LightingShaderMaterial>();
+	((LightingShaderMaterial*)m_ls.get())->setLightDir(fVector3(-3, -4, 10).normalise());
+	((LightingShaderMaterial*)m_ls.get())->setLightColor(fVector3::WHITE);
 
 	//build a scene
 	ModelPtr matPreviewMesh = AssetUtility::loadModel(&m_device, "mesh/sm_matpreviewmesh_02.dam");
@@ -37,9 +68,24 @@ bool Sample03::init(void)
 
 	Entity* entity = new Entity();
 	entity->build(fMatrix4::IDENTITY, matPreviewMesh, m_vs, m_ps);
+#ifdef ADDITIVE_BLEND
+	//x-ray look, all layers are accumulated
+	DepthStencilState noDepthWrite = DepthStencilState::makeDefault();
+	noDepthWrite.depthWrite = false;
+	entity->setBlendState(BlendState::makeAdditive());
+	entity->setDepthStencilState(noDepthWrite);
+#elif defined(TILED_LIGHTS) || defined(Z_PREPASS)
+	//depth is filled by Z-prepass, shade each pixel once
+	entity->setDepthStencilState(DepthStencilState::makeDepthEqual());
+#endif
 
 	m_model = std::shared_ptr<SceneObject>((SceneObject*)entity);
 	m_scene.addNode(m_model);
+	m_mesh = matPreviewMesh;
+
+#ifdef INSTANCING
+	_createInstances();
+#endif
 
 	return true;
 }
@@ -60,11 +106,146 @@ void Sample03::render(int32_t width, int32_t height)
 	m_camera.setClipRange(0.01f, 100.0f, false);
 	m_camera.setAspect(width / (float)height);
 
-	RenderQueue renderQueue;
-	m_scene.render(m_device, m_camera, renderQueue);
+	m_scene.render(m_device, m_camera, m_renderQueue);
+#ifdef COMMAND_LISTS
+	_recordCommandLists();
+#endif
+#ifndef TILED_LIGHTS
+	m_shadowMap.render(m_camera, m_renderQueue);
+#endif
 
 	//render!
 	m_renderTarget.init(width, height);
-	renderQueue.process(m_renderTarget);
+#ifdef VARIABLE_RATE_SHADING
+	//full rate at center of screen, coarser to the border
+	m_shadingRateImage.init(width, height);
+	for (int32_t y = 0; y < m_shadingRateImage.getHeight(); y++) {
+		for (int32_t x = 0; x < m_shadingRateImage.getWidth(); x++) {
+			float dx = fabsf((x + 0.5f) / m_shadingRateImage.getWidth() - 0.5f);
+			float dy = fabsf((y + 0.5f) / m_shadingRateImage.getHeight() - 0.5f);
+			float border = MathUtil::max2(dx, dy);
+			m_shadingRateImage.setPixel(x, y, border < 0.2f ? SR_1X1 : (border < 0.35f ? SR_2X2 : SR_4X4));
+		}
+	}
+	m_renderTarget.setShadingRateImage(&m_shadingRateImage);
+#endif
+
+	//passes of this frame, render target is owned by sample and the intermediate surfaces by graph
+	m_renderGraph.reset();
+	RenderGraph::ResourceHandle backBuffer = m_renderGraph.importResource("back_buffer");
+#ifdef DEFERRED_SHADING
+	RenderGraph::ResourceHandle gbuffer = m_renderGraph.createGBuffer("gbuffer", width, height);
+	m_renderGraph.addPass("geometry", {}, { gbuffer }, [this, gbuffer](const RenderGraph& graph) {
+		m_renderQueue.processGBuffer(graph.getGBuffer(gbuffer));
+	});
+	m_renderGraph.addPass("lighting", { gbuffer }, { backBuffer }, [this, gbuffer](const RenderGraph& graph) {
+		LightingShader::process(graph.getGBuffer(gbuffer), *m_ls, m_renderTarget);
+	});
+#else
+	m_renderGraph.addPass("scene", {}, { backBuffer }, [this](const RenderGraph&) {
+#if defined(VISIBILITY_BUFFER)
+		m_visibilityBuffer.init(m_renderTarget.getWidth(), m_renderTarget.getHeight());
+		m_renderQueue.processVisibility(m_visibilityBuffer, m_renderTarget);
+#elif defined(TILED_LIGHTS)
+		m_renderQueue.processZPrepass(m_renderTarget);
+		m_lightGrid.build(m_renderTarget.getDepthBuffer(), m_camera.getViewProjMatrix(), m_lights);
+		m_renderQueue.process(m_renderTarget);
+#elif defined(Z_PREPASS)
+		m_renderQueue.processZPrepass(m_renderTarget);
+		m_renderQueue.process(m_renderTarget);
+#else
+		m_renderQueue.process(m_renderTarget);
+#endif
+	});
+#endif
+
+#ifdef POST_PROCESS
+	//tonemap to sRGB, then anti-aliasing back into render target. 
+	//with deferred shading, the tone mapped surface takes the memory of gbuffer which is dead by then
+	RenderGraph::ResourceHandle toneMapped = m_renderGraph.createSurface("tone_mapped", { width, height, PF_FLOAT32_RGBA });
+	m_renderGraph.addPass("tone_map", { backBuffer }, { toneMapped }, [this, toneMapped](const RenderGraph& graph) {
+		PostProcess::toneMap(m_renderTarget.getColorBuffer(), 1.f, PostProcess::TM_ACES, true, graph.getPixelBuffer<fVector4>(toneMapped));
+	});
+	m_renderGraph.addPass("fxaa", { toneMapped }, { backBuffer }, [this, toneMapped](const RenderGraph& graph) {
+		PostProcess::fxaa(graph.getPixelBuffer<fVector4>(toneMapped), m_renderTarget.getColorBuffer());
+	});
+#endif
+
+	m_renderGraph.compile();
+	m_renderGraph.execute();
+}
+
+
+//-------------------------------------------------------------------------------------
+void Sample03::_recordCommandLists(void)
+{
+	//a ring of small copies of the model, each list is recorded by its own thread
+	enum { LIST_COUNTS = 4, COPIES_PER_LIST = 3 };
+
+	m_renderQueue.clearSubmitted();
+	while (m_commandLists.size() < LIST_COUNTS) {
+		m_commandLists.push_back(std::unique_ptr<CommandList>(new CommandList(&m_device)));
+	}
+
+	Parallel::parallelFor(LIST_COUNTS, [this](size_t index) {
+		CommandList& commandList = *(m_commandLists[index]);
+		commandList.reset();
+		commandList.setShaders(m_vs, m_ps);
+
+		for (size_t i = 0; i < COPIES_PER_LIST; i++) {
+			float angle = (float)(index*COPIES_PER_LIST + i) * MathUtil::PI * 2.f / (LIST_COUNTS*COPIES_PER_LIST);
+			fMatrix4 transform = fMatrix4::makeScale(0.006f, 0.006f, 0.006f) * fMatrix4::makeRotate_X(-MathUtil::PI_DIV2) *
+				fMatrix4::makeTrans(MathUtil::cos(angle)*4.f, -1.f, MathUtil::sin(angle)*4.f);
+
+			m_mesh->visit(transform, [&commandList](const fMatrix4& trans, const Model::MeshPart* meshPart) {
+				commandList.setWorldTransform(trans);
+				commandList.drawIndexed(meshPart->m_primitiveType, meshPart->m_vertexStreams, meshPart->m_indexBuffer);
+			});
+		}
+	});
+
+	//submission order is fixed whatever thread finished first
+	for (const std::unique_ptr<CommandList>& commandList : m_commandLists) {
+		m_renderQueue.submit(*commandList);
+	}
 }
 
+//-------------------------------------------------------------------------------------
+void Sample03::_createInstances(void)
+{
+	//same ring of small copies as the command lists, drawn by one entity
+	enum { INSTANCE_COUNTS = 12 };
+
+	m_instanceBuffer = std::make_shared<InstanceBuffer>();
+	m_instanceBuffer->build(&m_device, sizeof(VSStandard::InstanceConstants), INSTANCE_COUNTS);
+	for (size_t i = 0; i < INSTANCE_COUNTS; i++) {
+		float angle = (float)i * MathUtil::PI * 2.f / INSTANCE_COUNTS;
+
+		VSStandard::InstanceConstants instance;
+		instance.matWorld = fMatrix4::makeTrans(MathUtil::cos(angle)*4.f, -1.f, MathUtil::sin(angle)*4.f);
+		m_instanceBuffer->setInstance(i, &instance);
+	}
+
+	Entity* entity = new Entity();
+	entity->build(fMatrix4::makeScale(0.006f, 0.006f, 0.006f) * fMatrix4::makeRotate_X(-MathUtil::PI_DIV2), m_mesh, m_vs, m_ps);
+	entity->setInstanceBuffer(m_instanceBuffer);
+	m_scene.addNode(std::shared_ptr<SceneObject>((SceneObject*)entity));
+}
+
+//-------------------------------------------------------------------------------------
+void Sample03::_createLights(size_t counts)
+{
+	//random point and spot lights around the model
+	m_lights.resize(counts);
+	for (size_t i = 0; i < counts; i++) {
+		Light& light = m_lights[i];
+
+		light.type = (i % 4 == 0) ? Light::LT_SPOT : Light::LT_POINT;
+		light.position = fVector3(MathUtil::rangeRandom(-3.f, 3.f), MathUtil::rangeRandom(-1.f, 3.f), MathUtil::rangeRandom(-3.f, 3.f));
+		light.color = fVector3(MathUtil::unitRandom(), MathUtil::unitRandom(), MathUtil::unitRandom());
+		light.range = MathUtil::rangeRandom(0.5f, 1.5f);
+		light.direction = (fVector3(0.f, -1.f, 0.f) - light.position).normalise();
+		light.cosInnerCone = MathUtil::cos(MathUtil::PI / 8.f);
+		light.cosOuterCone = MathUtil::cos(MathUtil::PI / 6.f);
+	}
+}
@@ -9,14 +9,30 @@ public:
 
 	const Camera& getCamera(void) const { return m_camera; }
 
+private:
+	void _createLights(size_t counts);
+	void _recordCommandLists(void);
+	void _createInstances(void);
+
 private:
 	RenderDevice m_device;
+	RenderQueue m_renderQueue;
 	Scene  m_scene;
 	VertexShaderPtr m_vs;
 	PixelShaderPtr m_ps;
+	std::shared_ptr<LightingShader> m_ls;
+	VisibilityBuffer m_visibilityBuffer;
 	Camera m_camera;
+	ShadowMap m_shadowMap;
+	std::vector<Light> m_lights;
+	LightGrid m_lightGrid;
+	ShadingRateImage m_shadingRateImage;
+	RenderGraph m_renderGraph;
 
 	SceneObjectPtr m_model;
+	ModelPtr m_mesh;
+	std::vector<std::unique_ptr<CommandList>> m_commandLists;
+	InstanceBufferPtr m_instanceBuffer;
 
 	float m_rotateParam;
 };
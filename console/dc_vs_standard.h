@@ -1,4 +1,5 @@
 #include <davinci.h>
+#include <pipe/dv_pipe_static.h>
 using namespace davinci;
 
 
@@ -13,28 +14,31 @@ using namespace davinci;
 #define GET_ELEMENT(name)  _get_##name(input, inputVertexOffset)
 
 #define SET_ELEMENT_DEFINE_BEGIN(name, t) \
-	inline void _set_##name(float* vsout, const t* input, const VSConstantBuffer* param) const { \
+	inline void _set_##name(float* vsout, const t* input, const VSConstantBuffer* param, const InstanceConstants* instance) const { \
 		if(WITH_##name) { \
 
 #define SET_ELEMENT_DEFINE_END() }}
 
 template<bool WITH_NORMAL, bool WITH_TEXCOORD0>
-class VertexShaderStandard : public VertexShader
+class VertexShaderStandard : public VertexShaderT<VertexShaderStandard<WITH_NORMAL, WITH_TEXCOORD0>>
 {
 public:
 	struct VSConstantBuffer
 	{
 		fMatrix4 matWorld;
-		fMatrix4 matViewProj;
-		fVector3 eyePos;
+	};
+
+	//layout of InstanceBuffer, placed after the world transform of renderable
+	struct InstanceConstants
+	{
+		fMatrix4 matWorld;
 	};
 
 public:
+	//view constants(viewProj, eyePos) are shared by all renderables, see ConstantBuffer::VIEW_CONSTANT_SLOT
 	virtual void preRender(const fMatrix4& worldTransform, RenderablePtr renderable) const {
 		VSConstantBuffer param;
 		param.matWorld = worldTransform;
-		param.matViewProj = m_camera->getViewProjMatrix();
-		param.eyePos = m_camera->getEye();
 
 		renderable->setVSConstantBuffer(0, (const uint8_t*)&param, sizeof(VSConstantBuffer));
 	}
@@ -45,28 +49,53 @@ public:
 
 	//Set output defines
 	SET_ELEMENT_DEFINE_BEGIN(NORMAL, fVector3)
-		*((fVector3*)(vsout + m_vertexOutDesc.getElementOffset(VertexElementType::VET_NORMAL))) = (fVector4((*input), 0.f) * param->matWorld).xyz().normalise();
+		fVector4 normal = fVector4((*input), 0.f) * param->matWorld;
+		if (instance) normal = normal * instance->matWorld;
+		*((fVector3*)(vsout + m_vertexOutDesc.getElementOffset(VertexElementType::VET_NORMAL))) = normal.xyz().normalise();
 	SET_ELEMENT_DEFINE_END()
 
 	SET_ELEMENT_DEFINE_BEGIN(TEXCOORD0, fVector2)
 		*((fVector2*)(vsout + m_vertexOutDesc.getElementOffset(VertexElementType::VET_TEXCOORD0))) = (*input);
 	SET_ELEMENT_DEFINE_END()
 
-	virtual void vsFunction(ConstConstantBufferPtr constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const {
+	virtual void vsFunction(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const {
+		vsPosition(constantBuffer, input, inputVertexOffset, output, invZ);
+		vsAttribute(constantBuffer, input, inputVertexOffset, output);
+	}
+
+	virtual void vsPosition(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const {
 		fVector3* input_pos = (fVector3*)(input + inputVertexOffset[(size_t)VertexElementType::VET_POSITION]);
-		fVector3* input_normal = GET_ELEMENT(NORMAL);
-		fVector2* input_uv0 = GET_ELEMENT(TEXCOORD0);
 
 		const VSConstantBuffer* param = (const VSConstantBuffer*)(constantBuffer->getBuffer(0));
+		const ViewConstants* view = (const ViewConstants*)(constantBuffer->getBuffer(ConstantBuffer::VIEW_CONSTANT_SLOT));
+		const InstanceConstants* instance = (const InstanceConstants*)(constantBuffer->getBuffer(ConstantBuffer::INSTANCE_CONSTANT_SLOT));
 
 		fVector3 worldPos = (*input_pos) * param->matWorld;
+		if (instance) worldPos = worldPos * instance->matWorld;
+
+		//vsout->pos = worldPos * view->matViewProj;
+		*((fVector3*)(output + m_vertexOutDesc.getElementOffset(VertexElementType::VET_POSITION))) = worldPos * view->matViewProj;
 
-		//vsout->pos = worldPos * param->matViewProj;
-		*((fVector3*)(output + m_vertexOutDesc.getElementOffset(VertexElementType::VET_POSITION))) = worldPos * param->matViewProj;
-		_set_NORMAL(output, input_normal, param);
-		_set_TEXCOORD0(output, input_uv0, param);
+		invZ = 1.f / (worldPos - view->eyePos).length();
+	}
+
+	virtual void vsAttribute(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output) const {
+		fVector3* input_normal = GET_ELEMENT(NORMAL);
+		fVector2* input_uv0 = GET_ELEMENT(TEXCOORD0);
+
+		const VSConstantBuffer* param = (const VSConstantBuffer*)(constantBuffer->getBuffer(0));
+		const InstanceConstants* instance = (const InstanceConstants*)(constantBuffer->getBuffer(ConstantBuffer::INSTANCE_CONSTANT_SLOT));
+
+		_set_NORMAL(output, input_normal, param, instance);
+		_set_TEXCOORD0(output, input_uv0, param, instance);
+	}
 
-		invZ = 1.f / (worldPos - param->eyePos).length();
+	//position phase reads position only
+	virtual uint32_t getInputElementMask(bool attributePhase) const {
+		uint32_t mask = 1u << (uint32_t)VertexElementType::VET_POSITION;
+		if (attributePhase && WITH_NORMAL) mask |= 1u << (uint32_t)VertexElementType::VET_NORMAL;
+		if (attributePhase && WITH_TEXCOORD0) mask |= 1u << (uint32_t)VertexElementType::VET_TEXCOORD0;
+		return mask;
 	}
 
 	const VertexDesc& getOutputVertexDesc(void) const {
@@ -75,8 +104,7 @@ public:
 
 private:
 	VertexDesc m_vertexOutDesc;
-	Camera* m_camera;
 
 public:
-	VertexShaderStandard(const VertexDesc& vsoutDesc, Camera* camera) : m_vertexOutDesc(vsoutDesc), m_camera(camera) {	}
+	VertexShaderStandard(const VertexDesc& vsoutDesc) : m_vertexOutDesc(vsoutDesc) {	}
 };
@@ -121,6 +121,13 @@ ModelPtr AssetUtility::createStandardModel_Box(RenderDevice* device, float x_siz
 		0, 4, 1, 5, 2, 6, 3, 7
 	};
 
+	const uint16_t R = (uint16_t)IndexBuffer::RESTART_INDEX16;
+	uint16_t line_strip_indices[] = {
+		0, 1, 2, 3, 0, R,
+		4, 5, 6, 7, 4, R,
+		0, 4, R, 1, 5, R, 2, 6, R, 3, 7
+	};
+
 	uint16_t triangle_list_indices[] = {
 		3,1,0,
 		2,1,3,
@@ -141,6 +148,16 @@ ModelPtr AssetUtility::createStandardModel_Box(RenderDevice* device, float x_siz
 		23,20,22
 	};
 
+	//same triangles as the list, one strip per face
+	uint16_t triangle_strip_indices[] = {
+		0, 3, 1, 2, R,
+		5, 6, 4, 7, R,
+		8, 11, 9, 10, R,
+		13, 14, 12, 15, R,
+		16, 19, 17, 18, R,
+		21, 22, 20, 23
+	};
+
 	const size_t VERTEX_COUNTS = 24;
 
 	//create vertex buffer first
@@ -178,10 +195,18 @@ ModelPtr AssetUtility::createStandardModel_Box(RenderDevice* device, float x_siz
 		indexPtr->build(device, line_list_indices, sizeof(line_list_indices) / sizeof(line_list_indices[0]));
 		break;
 
+	case PT_LINE_STRIP:
+		indexPtr->build(device, line_strip_indices, sizeof(line_strip_indices) / sizeof(line_strip_indices[0]));
+		break;
+
 	case PT_TRIANGLE_LIST:
 		indexPtr->build(device, triangle_list_indices, sizeof(triangle_list_indices) / sizeof(triangle_list_indices[0]));
 		break;
 
+	case PT_TRIANGLE_STRIP:
+		indexPtr->build(device, triangle_strip_indices, sizeof(triangle_strip_indices) / sizeof(triangle_strip_indices[0]));
+		break;
+
 	default:
 		return nullptr;
 	}
@@ -191,7 +216,7 @@ ModelPtr AssetUtility::createStandardModel_Box(RenderDevice* device, float x_siz
 	
 	//add sub mesh
 	Model::MeshPart meshPart;
-	meshPart.m_vertexBuffer = vertexPtr;
+	meshPart.m_vertexStreams.push_back(vertexPtr);
 	meshPart.m_indexBuffer = indexPtr;
 	meshPart.m_primitiveType = primitiveType;
 	modelPtr->m_meshes.push_back(meshPart);
@@ -326,7 +351,7 @@ ModelPtr AssetUtility::createStandardModel_Sphere(RenderDevice* device, float ra
 	
 	//add sub mesh
 	Model::MeshPart meshPart;
-	meshPart.m_vertexBuffer = vertexPtr;
+	meshPart.m_vertexStreams.push_back(vertexPtr);
 	meshPart.m_indexBuffer = indexPtr;
 	meshPart.m_primitiveType = primitiveType;
 	modelPtr->m_meshes.push_back(meshPart);
@@ -607,6 +632,24 @@ static bool _parseVertexElementType(const char* strType, VertexElementType& attr
 	return false;
 }
 
+//-------------------------------------------------------------------------------------
+//vertex stream of an element, position is alone so depth-only passes fetch nothing else
+static size_t _vertexStreamOf(VertexElementType attribute)
+{
+	switch (attribute)
+	{
+	case VertexElementType::VET_POSITION:
+		return 0;
+	case VertexElementType::VET_NORMAL:
+	case VertexElementType::VET_COLOR:
+	case VertexElementType::VET_TANGENT:
+	case VertexElementType::VET_BINORMAL:
+		return 1;
+	default:
+		return 2;
+	}
+}
+
 //-------------------------------------------------------------------------------------
 static bool _parsePrimitiveType(const char* strType, PrimitiveType& type)
 {
@@ -692,6 +735,7 @@ ModelPtr AssetUtility::loadModel(RenderDevice* device, const char* jsonFileName)
 	for (const auto& mesh_json : json["meshes"].GetArray()) {
 
 		VertexDesc vertexDesc;
+		std::vector<std::pair<VertexElementType, VertexElementFormat>> elements;
 
 		//parse attributes
 		if (!mesh_json["attributes"].IsArray()) return nullptr;
@@ -708,7 +752,7 @@ ModelPtr AssetUtility::loadModel(RenderDevice* device, const char* jsonFileName)
 			case VertexElementType::VET_COLOR:
 			case VertexElementType::VET_TANGENT:
 			case VertexElementType::VET_BINORMAL:
-				vertexDesc.addElement(attribute, VET_FLOAT_X3); break;
+				elements.push_back({ attribute, VET_FLOAT_X3 }); break;
 			case VertexElementType::VET_TEXCOORD0:
 			case VertexElementType::VET_TEXCOORD1:
 			case VertexElementType::VET_TEXCOORD2:
@@ -717,11 +761,14 @@ ModelPtr AssetUtility::loadModel(RenderDevice* device, const char* jsonFileName)
 			case VertexElementType::VET_TEXCOORD5:
 			case VertexElementType::VET_TEXCOORD6:
 			case VertexElementType::VET_TEXCOORD7:
-				vertexDesc.addElement(attribute, VET_FLOAT_X2); break;
+				elements.push_back({ attribute, VET_FLOAT_X2 }); break;
 			default:
 				break;
 			}
 		}
+		for (const auto& element : elements) {
+			vertexDesc.addElement(element.first, element.second);
+		}
 		//check vertices size
 		size_t vertexSize = vertexDesc.vertexSize();
 		if (vertexSize == 0) return nullptr;
@@ -737,16 +784,38 @@ ModelPtr AssetUtility::loadModel(RenderDevice* device, const char* jsonFileName)
 			dataVertices[i] = vertices_array_json[i].GetFloat();
 		}
 
-		//create vertex buffer
-		VertexBufferPtr vertexBufferPtr = std::shared_ptr<VertexBuffer>(new VertexBuffer());
-		vertexBufferPtr->build(device, vertexDesc, dataVertices, vertexCounts);
+		//split into vertex streams(position, normal/tangent/color, uv)
+		std::vector<VertexBufferPtr> vertexStreams;
+		for (size_t stream = 0; stream < 3; stream++) {
+			VertexDesc streamDesc;
+			for (const auto& element : elements) {
+				if (_vertexStreamOf(element.first) == stream) streamDesc.addElement(element.first, element.second);
+			}
+			size_t streamVertexSize = streamDesc.vertexSize();
+			if (streamVertexSize == 0) continue;
+
+			std::vector<float> streamVertices(streamVertexSize * vertexCounts);
+			for (size_t i = 0; i < vertexCounts; i++) {
+				for (const auto& element : elements) {
+					if (_vertexStreamOf(element.first) != stream) continue;
+
+					memcpy(&(streamVertices[i*streamVertexSize + (size_t)streamDesc.getElementOffset(element.first)]),
+						dataVertices + i*vertexSize + vertexDesc.getElementOffset(element.first), 
+						VertexDesc::elementSize(element.second) * sizeof(float));
+				}
+			}
+
+			VertexBufferPtr vertexBufferPtr = std::shared_ptr<VertexBuffer>(new VertexBuffer());
+			vertexBufferPtr->build(device, streamDesc, &(streamVertices[0]), vertexCounts);
+			vertexStreams.push_back(vertexBufferPtr);
+		}
 		delete[] dataVertices;
 
 		//create mesh part(s)
 		if (!mesh_json["parts"].IsArray()) return nullptr;
 		for (const auto& mesh_part_json : mesh_json["parts"].GetArray()) {
 			Model::MeshPart meshPart;
-			meshPart.m_vertexBuffer = vertexBufferPtr;
+			meshPart.m_vertexStreams = vertexStreams;
 			meshPart.m_indexBuffer = std::shared_ptr<IndexBuffer>(new IndexBuffer());
 
 			//id
@@ -761,13 +830,25 @@ ModelPtr AssetUtility::loadModel(RenderDevice* device, const char* jsonFileName)
 			if (!mesh_part_json["indices"].IsArray()) return nullptr;
 			const auto& mesh_part_indices_json = mesh_part_json["indices"].GetArray();
 			size_t indicesCounts = mesh_part_indices_json.Size();
+			if (indicesCounts == 0) return nullptr;
 
-			uint16_t* indicesData = new uint16_t[indicesCounts];
+			//-1 is the restart index of strips, 32-bit indices only if the vertices can't be addressed by 16-bit
+			const int64_t minIndex = isStripPrimitive(meshPart.m_primitiveType) ? -1 : 0;
+			std::vector<uint32_t> indicesData(indicesCounts);
 			for(rapidjson::SizeType i = 0; i < indicesCounts; i++) {
-				indicesData[i] = (uint16_t)mesh_part_indices_json[i].GetInt();
+				int64_t index = mesh_part_indices_json[i].GetInt64();
+				if (index < minIndex || index >= (int64_t)vertexCounts) return nullptr;
+
+				indicesData[i] = (index < 0) ? (uint32_t)IndexBuffer::RESTART_INDEX32 : (uint32_t)index;
+			}
+
+			if (vertexCounts < IndexBuffer::RESTART_INDEX16) {
+				std::vector<uint16_t> indices16(indicesData.begin(), indicesData.end());
+				meshPart.m_indexBuffer->build(device, &(indices16[0]), indicesCounts);
+			}
+			else {
+				meshPart.m_indexBuffer->build(device, &(indicesData[0]), indicesCounts);
 			}
-			meshPart.m_indexBuffer->build(device, indicesData, indicesCounts);
-			delete[] indicesData;
 
 			//insert in model
 			meshPartID.insert({ meshPart.m_name, modelPtr->m_meshes.size() });
@@ -12,7 +12,7 @@ public:
 	struct MeshPart
 	{
 		std::string		m_name;
-		VertexBufferPtr	m_vertexBuffer;
+		std::vector<VertexBufferPtr> m_vertexStreams;
 		IndexBufferPtr	m_indexBuffer;
 		PrimitiveType	m_primitiveType;
 	};
@@ -4,11 +4,30 @@
 #include "dv_prerequisites.h"
 
 #include "device/dv_render_device.h"
+#include "device/dv_vertex_buffer.h"
+#include "device/dv_index_buffer.h"
+#include "device/dv_instance_buffer.h"
 #include "device/dv_render_target.h"
+#include "device/dv_render_target_set.h"
+#include "device/dv_depth_buffer.h"
+#include "device/dv_shading_rate_image.h"
+#include "device/dv_blend_state.h"
+#include "device/dv_depth_stencil_state.h"
+#include "device/dv_gbuffer.h"
+#include "device/dv_visibility_buffer.h"
+#include "device/dv_parallel.h"
 
 #include "pipe/dv_render_queue.h"
+#include "pipe/dv_command_list.h"
+#include "pipe/dv_render_graph.h"
+#include "pipe/dv_post_process.h"
 #include "pipe/dv_pipe_VS.h"
+#include "pipe/dv_pipe_PA.h"
 #include "pipe/dv_pipe_PS.h"
+#include "pipe/dv_pipe_deferred.h"
+#include "pipe/dv_pipe_visibility.h"
+#include "pipe/dv_pipe_depth.h"
+#include "pipe/dv_pipe_tiled_lights.h"
 #include "pipe/dv_rasterizer.h"
 
 #include "asset/dv_asset_utility.h"
@@ -17,3 +36,4 @@
 #include "scene/dv_scene.h"
 #include "scene/dv_camera.h"
 #include "scene/dv_entity.h"
+#include "scene/dv_shadow_map.h"
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+namespace davinci
+{
+
+enum BlendFactor
+{
+	BF_ZERO,
+	BF_ONE,
+	BF_SRC_COLOR,
+	BF_INV_SRC_COLOR,
+	BF_SRC_ALPHA,
+	BF_INV_SRC_ALPHA,
+	BF_DEST_COLOR,
+	BF_INV_DEST_COLOR,
+	BF_DEST_ALPHA,
+	BF_INV_DEST_ALPHA,
+};
+
+enum BlendOp
+{
+	BO_ADD,				//src*srcFactor + dest*destFactor
+	BO_SUBTRACT,		//src*srcFactor - dest*destFactor
+	BO_REV_SUBTRACT,	//dest*destFactor - src*srcFactor
+	BO_MIN,				//min(src, dest), factors are ignored
+	BO_MAX,				//max(src, dest), factors are ignored
+};
+
+//How the color of pixel shader is combined with render target, alpha channel has its own factors
+struct BlendState
+{
+	bool		blendEnable;
+	BlendFactor	srcBlend;
+	BlendFactor	destBlend;
+	BlendOp		blendOp;
+	BlendFactor	srcBlendAlpha;
+	BlendFactor	destBlendAlpha;
+	BlendOp		blendOpAlpha;
+
+	static BlendState makeOpaque(void) {
+		BlendState state = { false, BF_ONE, BF_ZERO, BO_ADD, BF_ONE, BF_ZERO, BO_ADD };
+		return state;
+	}
+
+	static BlendState makeAlphaBlend(void) {
+		BlendState state = { true, BF_SRC_ALPHA, BF_INV_SRC_ALPHA, BO_ADD, BF_ONE, BF_INV_SRC_ALPHA, BO_ADD };
+		return state;
+	}
+
+	static BlendState makeAdditive(void) {
+		BlendState state = { true, BF_ONE, BF_ONE, BO_ADD, BF_ONE, BF_ONE, BO_ADD };
+		return state;
+	}
+};
+
+}
@@ -10,8 +10,10 @@ namespace davinci
 //-------------------------------------------------------------------------------------
 ConstantBuffer::ConstantBuffer(const RenderDevice* device)
 	: m_device(device)
+	, m_instanceID(0)
 {
 	m_constantBuffer.resize(MAX_BUFFER_COUNTS);
+	std::fill(m_bufferPtr, m_bufferPtr + MAX_BUFFER_COUNTS, nullptr);
 }
 
 //-------------------------------------------------------------------------------------
@@ -26,19 +28,32 @@ void ConstantBuffer::setBuffer(int32_t index, const uint8_t* buffer, size_t leng
 	assert(index >= 0 && index < MAX_BUFFER_COUNTS);
 	if (index < 0 || index >= MAX_BUFFER_COUNTS) return;
 
-	DeviceBufferPtr deviceBuffer = m_constantBuffer[(size_t)index] = m_device->createDeviceBuffer(length);
+	//rewrite in place if the old buffer is big enough, so updating every frame doesn't touch allocator
+	DeviceBufferPtr deviceBuffer = m_constantBuffer[(size_t)index] = m_device->reuseDeviceBuffer(m_constantBuffer[(size_t)index], length);
 
 	memcpy(deviceBuffer->ptr(0), buffer, length);
+	m_bufferPtr[index] = deviceBuffer->ptr(0);
 }
 
 //-------------------------------------------------------------------------------------
-const uint8_t* ConstantBuffer::getBuffer(int32_t index) const
+void ConstantBuffer::bindBuffer(int32_t index, const uint8_t* buffer)
 {
 	assert(index >= 0 && index < MAX_BUFFER_COUNTS);
-	if (index < 0 || index >= MAX_BUFFER_COUNTS) return nullptr;
+	if (index < 0 || index >= MAX_BUFFER_COUNTS) return;
 
-	DeviceBufferPtr deviceBuffer = m_constantBuffer[(size_t)index];
-	return deviceBuffer->ptr(0);
+	m_constantBuffer[(size_t)index] = nullptr;
+	m_bufferPtr[index] = buffer;
 }
 
-}
\ No newline at end of file
+//-------------------------------------------------------------------------------------
+void ConstantBuffer::bindInstance(const ConstantBuffer& constantBuffer, const uint8_t* instance, uint32_t instanceID)
+{
+	//device buffers are still owned by the source, only the raw pointers are needed by shaders
+	std::copy(constantBuffer.m_bufferPtr, constantBuffer.m_bufferPtr + MAX_BUFFER_COUNTS, m_bufferPtr);
+	std::fill(m_constantBuffer.begin(), m_constantBuffer.end(), nullptr);
+
+	m_bufferPtr[INSTANCE_CONSTANT_SLOT] = instance;
+	m_instanceID = instanceID;
+}
+
+}
@@ -5,16 +5,40 @@
 namespace davinci
 {
 
+//Constants shared by all renderables of one view, updated once per frame by RenderQueue::setCamera 
+//and bound to ConstantBuffer::VIEW_CONSTANT_SLOT of each renderable
+struct ViewConstants
+{
+	fMatrix4 matViewProj;
+	fVector3 eyePos;
+};
+
 class ConstantBuffer
 {
 public:
-	enum { MAX_BUFFER_COUNTS = 16 };
+	enum { MAX_BUFFER_COUNTS = 16, VIEW_CONSTANT_SLOT = MAX_BUFFER_COUNTS - 1, INSTANCE_CONSTANT_SLOT = MAX_BUFFER_COUNTS - 2 };
+	//copy into the slot, the device buffer of slot is rewritten in place if it's big enough
 	void setBuffer(int32_t index, const uint8_t* buffer, size_t length);
-	const uint8_t* getBuffer(int32_t index) const;
+	//bind external memory to the slot without copy, the memory must outlive the binding
+	void bindBuffer(int32_t index, const uint8_t* buffer);
+	//bind all slots of another constant buffer without copy, then the data of one instance(see InstanceBuffer)
+	void bindInstance(const ConstantBuffer& constantBuffer, const uint8_t* instance, uint32_t instanceID);
+
+	//raw pointer is resolved when the slot is set, so shaders can read it per vertex/pixel without reference counting
+	const uint8_t* getBuffer(int32_t index) const {
+		assert(index >= 0 && index < MAX_BUFFER_COUNTS);
+		return m_bufferPtr[index];
+	}
+	//index of the instance being drawn, 0 for renderables without instance buffer
+	uint32_t getInstanceID(void) const {
+		return m_instanceID;
+	}
 
 private:
 	const RenderDevice* m_device;
 	DeviceBufferVector m_constantBuffer;
+	const uint8_t* m_bufferPtr[MAX_BUFFER_COUNTS];
+	uint32_t m_instanceID;
 
 public:
 	ConstantBuffer(const RenderDevice* device);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+#include "dv_pixel_buffer.h"
+
+namespace davinci
+{
+
+//Depth buffer with an 8-bit stencil plane, also the target of depth-only rendering(shadow map, Z-prepass)
+class DepthBuffer : public PixelBuffer<float>
+{
+public:
+	//clear depth to the far end and stencil to 0
+	void init(int width, int height) {
+		PixelBuffer<float>::init(width, height, std::numeric_limits<float>::max());
+		m_stencilBuffer.init(width, height, 0);
+	}
+	//depth and stencil planes in storage of getMemorySize bytes owned by caller
+	void init(int width, int height, uint8_t* storage) {
+		PixelBuffer<float>::init(width, height, std::numeric_limits<float>::max(), storage);
+		m_stencilBuffer.init(width, height, 0, storage + PixelBuffer<float>::getMemorySize(width, height));
+	}
+	static size_t getMemorySize(int width, int height) {
+		return PixelBuffer<float>::getMemorySize(width, height) + PixelBuffer<uint8_t>::getMemorySize(width, height);
+	}
+
+	uint8_t getStencil(int32_t x, int32_t y) const {
+		return m_stencilBuffer.getPixel(x, y);
+	}
+	void setStencil(int32_t x, int32_t y, uint8_t stencil) {
+		m_stencilBuffer.setPixel(x, y, stencil);
+	}
+
+	//depth test and write, return true if passed
+	bool testAndSet(int32_t x, int32_t y, float depth, CompareFunc func) {
+		if (x < 0 || x >= m_width || y < 0 || y >= m_height) return false;
+
+		float& current = m_pixels[(size_t)(y*m_width + x)];
+		if (!compareValue(func, depth, current)) return false;
+
+		current = depth;
+		return true;
+	}
+
+private:
+	PixelBuffer<uint8_t> m_stencilBuffer;
+};
+
+}
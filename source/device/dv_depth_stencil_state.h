@@ -0,0 +1,74 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+namespace davinci
+{
+
+enum StencilOp
+{
+	SO_KEEP,
+	SO_ZERO,
+	SO_REPLACE,		//set to reference value
+	SO_INCR_SAT,
+	SO_DECR_SAT,
+	SO_INVERT,
+	SO_INCR_WRAP,
+	SO_DECR_WRAP,
+};
+
+//Depth and stencil test of a draw. 
+//stencil test passes if (stencilRef & stencilReadMask) stencilFunc (stencil & stencilReadMask)
+struct DepthStencilState
+{
+	bool		depthEnable;
+	bool		depthWrite;
+	CompareFunc	depthFunc;
+
+	bool		stencilEnable;
+	uint8_t		stencilRef;
+	uint8_t		stencilReadMask;
+	uint8_t		stencilWriteMask;
+	CompareFunc	stencilFunc;
+	StencilOp	stencilFailOp;	//stencil test failed
+	StencilOp	depthFailOp;	//stencil test passed, depth test failed
+	StencilOp	passOp;			//both passed
+
+	//depth test CF_LESS_EQUAL with depth write, no stencil
+	static DepthStencilState makeDefault(void) {
+		DepthStencilState state = { true, true, CF_LESS_EQUAL, false, 0, 0xFF, 0xFF, CF_ALWAYS, SO_KEEP, SO_KEEP, SO_KEEP };
+		return state;
+	}
+
+	//shading pass after a Z-prepass, depth test CF_EQUAL without write
+	static DepthStencilState makeDepthEqual(void) {
+		DepthStencilState state = makeDefault();
+		state.depthWrite = false;
+		state.depthFunc = CF_EQUAL;
+		return state;
+	}
+
+	bool isDefault(void) const {
+		return depthEnable && depthWrite && depthFunc == CF_LESS_EQUAL && !stencilEnable;
+	}
+
+	//rejected pixels don't change stencil buffer, so they can be rejected before pixel shader
+	bool isFailOpKeep(void) const {
+		return !stencilEnable || stencilWriteMask == 0 || (stencilFailOp == SO_KEEP && depthFailOp == SO_KEEP);
+	}
+
+	static uint8_t applyStencilOp(StencilOp op, uint8_t stencil, uint8_t ref) {
+		switch (op) {
+		case SO_ZERO: return 0;
+		case SO_REPLACE: return ref;
+		case SO_INCR_SAT: return stencil == 0xFF ? stencil : (uint8_t)(stencil + 1);
+		case SO_DECR_SAT: return stencil == 0 ? stencil : (uint8_t)(stencil - 1);
+		case SO_INVERT: return (uint8_t)~stencil;
+		case SO_INCR_WRAP: return (uint8_t)(stencil + 1);
+		case SO_DECR_WRAP: return (uint8_t)(stencil - 1);
+		default: return stencil;
+		}
+	}
+};
+
+}
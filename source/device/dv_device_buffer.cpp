@@ -8,6 +8,7 @@ namespace davinci
 DeviceBuffer::DeviceBuffer()
 	: m_ptr(nullptr)
 	, m_size(0)
+	, m_external(false)
 {
 }
 
@@ -28,14 +29,26 @@ void DeviceBuffer::init(size_t size)
 	m_size = size;
 }
 
+//-------------------------------------------------------------------------------------
+void DeviceBuffer::wrap(void* ptr, size_t size)
+{
+	assert(ptr && size > 0);
+	clear();
+
+	m_ptr = (uint8_t*)ptr;
+	m_size = size;
+	m_external = true;
+}
+
 //-------------------------------------------------------------------------------------
 void DeviceBuffer::clear(void)
 {
-	if (m_ptr) {
+	if (m_ptr && !m_external) {
 		free(m_ptr);
-		m_ptr = nullptr;
 	}
+	m_ptr = nullptr;
 	m_size = 0;
+	m_external = false;
 }
 
 }
\ No newline at end of file
@@ -9,8 +9,12 @@ class DeviceBuffer
 {
 public:
 	void init(size_t size);
+	//use caller-owned memory, which must outlive this buffer and is never freed here
+	void wrap(void* ptr, size_t size);
 	void clear(void);
 
+	bool isExternal(void) const { return m_external; }
+
 	size_t size(void) const { return m_size; }
 
 	const uint8_t* ptr(size_t offseet) const {
@@ -22,6 +26,7 @@ public:
 private:
 	uint8_t*	m_ptr;
 	size_t		m_size;
+	bool		m_external;
 
 public:
 	DeviceBuffer();
@@ -0,0 +1,56 @@
+#include "dv_precompiled.h"
+#include "dv_gbuffer.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+GBuffer::GBuffer()
+	: m_width(0)
+	, m_height(0)
+{
+}
+
+//-------------------------------------------------------------------------------------
+void GBuffer::init(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_normalBuffer.init(width, height, fVector3::ZERO);
+	m_albedoBuffer.init(width, height, fVector4::BLACK);
+	m_depthBuffer.init(width, height, std::numeric_limits<float>::max());
+}
+
+//-------------------------------------------------------------------------------------
+void GBuffer::init(int width, int height, uint8_t* storage)
+{
+	m_width = width;
+	m_height = height;
+	m_albedoBuffer.init(width, height, fVector4::BLACK, storage);
+	storage += PixelBuffer<fVector4>::getMemorySize(width, height);
+	m_normalBuffer.init(width, height, fVector3::ZERO, storage);
+	storage += PixelBuffer<fVector3>::getMemorySize(width, height);
+	m_depthBuffer.init(width, height, std::numeric_limits<float>::max(), storage);
+}
+
+//-------------------------------------------------------------------------------------
+size_t GBuffer::getMemorySize(int width, int height)
+{
+	return PixelBuffer<fVector4>::getMemorySize(width, height) + PixelBuffer<fVector3>::getMemorySize(width, height) + 
+		PixelBuffer<float>::getMemorySize(width, height);
+}
+
+//-------------------------------------------------------------------------------------
+void GBuffer::setPixel(int32_t x, int32_t y, const GBufferPixel& pixel, float depth)
+{
+	if (x < 0 || x >= m_width || y<0 || y >= m_height) return;
+
+	if (depth > m_depthBuffer.getPixel(x, y)) {
+		return;
+	}
+	m_normalBuffer.setPixel(x, y, pixel.normal);
+	m_albedoBuffer.setPixel(x, y, pixel.albedo);
+	m_depthBuffer.setPixel(x, y, depth);
+}
+
+}
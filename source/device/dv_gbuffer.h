@@ -0,0 +1,50 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+#include "dv_pixel_buffer.h"
+
+namespace davinci
+{
+
+//Surface attributes of one pixel, written by geometry pass of deferred shading
+struct GBufferPixel
+{
+	fVector3 normal;
+	fVector4 albedo;
+};
+
+//Multi-channel render target for deferred shading(normal, albedo and depth)
+class GBuffer
+{
+public:
+	void init(int width, int height);
+	//all channels in storage of getMemorySize bytes owned by caller
+	void init(int width, int height, uint8_t* storage);
+	static size_t getMemorySize(int width, int height);
+	void setPixel(int32_t x, int32_t y, const GBufferPixel& pixel, float depth);
+
+	//pixel without any geometry
+	bool isEmpty(int32_t x, int32_t y) const {
+		return m_depthBuffer.getPixel(x, y) == std::numeric_limits<float>::max();
+	}
+
+	int32_t getWidth(void) const { return m_width; }
+	int32_t getHeight(void) const { return m_height; }
+	const PixelBuffer<fVector3>& getNormalBuffer(void) const { return m_normalBuffer; }
+	const PixelBuffer<fVector4>& getAlbedoBuffer(void) const { return m_albedoBuffer; }
+	const PixelBuffer<float>& getDepthBuffer(void) const { return m_depthBuffer; }
+
+private:
+	int32_t m_width;
+	int32_t m_height;
+	PixelBuffer<fVector3> m_normalBuffer;
+	PixelBuffer<fVector4> m_albedoBuffer;
+	PixelBuffer<float> m_depthBuffer;
+
+public:
+	GBuffer();
+	~GBuffer() {}
+};
+
+}
@@ -9,24 +9,100 @@ namespace davinci
 
 //-------------------------------------------------------------------------------------
 void IndexBuffer::build(const RenderDevice* device, uint16_t* indices, size_t indexCounts)
+{
+	_build(device, indices, indexCounts, IF_UINT16);
+}
+
+//-------------------------------------------------------------------------------------
+void IndexBuffer::build(const RenderDevice* device, uint32_t* indices, size_t indexCounts)
+{
+	_build(device, indices, indexCounts, IF_UINT32);
+}
+
+//-------------------------------------------------------------------------------------
+void IndexBuffer::_build(const RenderDevice* device, const void* indices, size_t indexCounts, IndexFormat format)
 {
 	assert(indices && indexCounts>0);
 
-	m_indices = device->createDeviceBuffer(indexCounts*sizeof(uint16_t));
+	m_format = format;
+	m_indices[0] = device->createDeviceBuffer(indexCounts*indexSize());
+	m_indices[1] = nullptr;
+	m_front = 0;
 
-	memcpy(m_indices->ptr(0), indices, sizeof(uint16_t) * indexCounts);
+	memcpy(m_indices[0]->ptr(0), indices, indexCounts*indexSize());
+}
+
+//-------------------------------------------------------------------------------------
+void IndexBuffer::buildDynamic(const RenderDevice* device, size_t indexCounts, IndexFormat format)
+{
+	assert(indexCounts>0);
+
+	m_format = format;
+	m_indices[0] = device->createDeviceBuffer(indexCounts*indexSize());
+	m_indices[1] = device->createDeviceBuffer(indexCounts*indexSize());
+	m_front = 0;
+}
+
+//-------------------------------------------------------------------------------------
+void IndexBuffer::wrap(const RenderDevice* device, uint16_t* indices, size_t indexCounts)
+{
+	_wrap(device, indices, indexCounts, IF_UINT16);
+}
+
+//-------------------------------------------------------------------------------------
+void IndexBuffer::wrap(const RenderDevice* device, uint32_t* indices, size_t indexCounts)
+{
+	_wrap(device, indices, indexCounts, IF_UINT32);
+}
+
+//-------------------------------------------------------------------------------------
+void IndexBuffer::_wrap(const RenderDevice* device, void* indices, size_t indexCounts, IndexFormat format)
+{
+	assert(indices && indexCounts>0);
+
+	m_format = format;
+	m_indices[0] = device->wrapDeviceBuffer(indices, indexCounts*indexSize());
+	m_indices[1] = nullptr;
+	m_front = 0;
+}
+
+//-------------------------------------------------------------------------------------
+void* IndexBuffer::map(void)
+{
+	assert(!m_mapped);
+	m_mapped = true;
+
+	return m_indices[isDynamic() ? 1 - m_front : m_front]->ptr(0);
+}
+
+//-------------------------------------------------------------------------------------
+void IndexBuffer::unmap(void)
+{
+	assert(m_mapped);
+	m_mapped = false;
+
+	if (isDynamic()) m_front = 1 - m_front;
 }
 
 //-------------------------------------------------------------------------------------
 size_t IndexBuffer::counts(void) const 
 { 
-	return m_indices->size() / sizeof(uint16_t);
+	return m_indices[m_front]->size() / indexSize();
+}
+
+//-------------------------------------------------------------------------------------
+const void* IndexBuffer::rawPtr(void) const
+{
+	return m_indices[m_front]->ptr(0);
 }
 
 //-------------------------------------------------------------------------------------
-uint16_t IndexBuffer::get(size_t index) const 
+uint32_t IndexBuffer::get(size_t index) const 
 { 
-	return *((const uint16_t*)m_indices->ptr(index * sizeof(uint16_t)));
+	if (m_format == IF_UINT32) {
+		return *((const uint32_t*)m_indices[m_front]->ptr(index * sizeof(uint32_t)));
+	}
+	return *((const uint16_t*)m_indices[m_front]->ptr(index * sizeof(uint16_t)));
 }
 
 }
@@ -8,18 +8,51 @@ namespace davinci
 class IndexBuffer : noncopyable
 {
 public:
+	//cut a strip, the next index starts a new one
+	enum : uint32_t { RESTART_INDEX16 = 0xFFFF, RESTART_INDEX32 = 0xFFFFFFFF };
+
 	void build(const RenderDevice* device, uint16_t* indices, size_t indexCounts);
+	void build(const RenderDevice* device, uint32_t* indices, size_t indexCounts);
+	//build double buffered index buffer, filled by map/unmap every frame
+	void buildDynamic(const RenderDevice* device, size_t indexCounts, IndexFormat format = IF_UINT16);
+	//use caller-owned indices without copy, the memory must outlive this buffer
+	void wrap(const RenderDevice* device, uint16_t* indices, size_t indexCounts);
+	void wrap(const RenderDevice* device, uint32_t* indices, size_t indexCounts);
+
+	//get the buffer to write(uint16_t or uint32_t by format), see VertexBuffer::map
+	void* map(void);
+	//publish the data written after map
+	void unmap(void);
+
+	//is double buffered
+	bool isDynamic(void) const { return m_indices[1] != nullptr; }
+
+	//get index format
+	IndexFormat getFormat(void) const { return m_format; }
+	//get size of one index in bytes
+	size_t indexSize(void) const { return m_format == IF_UINT32 ? sizeof(uint32_t) : sizeof(uint16_t); }
+	//get restart index of the format
+	uint32_t getRestartIndex(void) const { return m_format == IF_UINT32 ? RESTART_INDEX32 : RESTART_INDEX16; }
 
 	//get index counts
 	size_t counts(void) const;
 	//get data
-	uint16_t get(size_t index) const;
+	uint32_t get(size_t index) const;
+	//get all indices, uint16_t or uint32_t by format
+	const void* rawPtr(void) const;
+
+private:
+	void _build(const RenderDevice* device, const void* indices, size_t indexCounts, IndexFormat format);
+	void _wrap(const RenderDevice* device, void* indices, size_t indexCounts, IndexFormat format);
 
 private:
-	DeviceBufferPtr m_indices;
+	DeviceBufferPtr m_indices[2];
+	IndexFormat m_format;
+	size_t m_front;		//index of the buffer read by pipeline
+	bool m_mapped;
 
 public:
-	IndexBuffer() {}
+	IndexBuffer() : m_format(IF_UINT16), m_front(0), m_mapped(false) {}
 	~IndexBuffer() {}
 };
 
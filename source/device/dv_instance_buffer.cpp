@@ -0,0 +1,40 @@
+#include "dv_precompiled.h"
+#include "dv_instance_buffer.h"
+
+#include "dv_render_device.h"
+#include "dv_device_buffer.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+void InstanceBuffer::build(const RenderDevice* device, size_t instanceSize, size_t instanceCounts, const void* instances)
+{
+	assert(instanceSize > 0 && instanceCounts > 0);
+
+	m_instanceSize = instanceSize;
+	m_counts = instanceCounts;
+	m_instances = device->reuseDeviceBuffer(m_instances, instanceSize * instanceCounts);
+
+	if (instances) {
+		memcpy(m_instances->ptr(0), instances, instanceSize * instanceCounts);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void InstanceBuffer::setInstance(size_t index, const void* instance)
+{
+	assert(index < m_counts);
+
+	memcpy(m_instances->ptr(index * m_instanceSize), instance, m_instanceSize);
+}
+
+//-------------------------------------------------------------------------------------
+const uint8_t* InstanceBuffer::ptr(size_t index) const
+{
+	assert(index < m_counts);
+
+	return m_instances->ptr(index * m_instanceSize);
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+namespace davinci
+{
+
+//Per-instance data of an instanced renderable, layout is defined by the vertex shader.
+//Data of the instance being drawn is bound to ConstantBuffer::INSTANCE_CONSTANT_SLOT
+class InstanceBuffer : noncopyable
+{
+public:
+	//instanceSize is in bytes, the device buffer is reused if it's big enough so it can be rebuilt every frame
+	void build(const RenderDevice* device, size_t instanceSize, size_t instanceCounts, const void* instances = nullptr);
+	//copy data of one instance
+	void setInstance(size_t index, const void* instance);
+
+	//get instance counts
+	size_t counts(void) const { return m_counts; }
+	//get size of one instance in bytes
+	size_t instanceSize(void) const { return m_instanceSize; }
+
+	//get data
+	const uint8_t* ptr(size_t index) const;
+
+private:
+	DeviceBufferPtr m_instances;
+	size_t m_instanceSize;
+	size_t m_counts;
+
+public:
+	InstanceBuffer() : m_instanceSize(0), m_counts(0) {}
+	~InstanceBuffer() {}
+};
+
+}
@@ -0,0 +1,66 @@
+#include "dv_precompiled.h"
+#include "dv_parallel.h"
+
+#include <thread>
+#include <atomic>
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+size_t Parallel::getThreadCounts(void)
+{
+	static const size_t threadCounts = MathUtil::max2((size_t)std::thread::hardware_concurrency(), (size_t)1);
+	return threadCounts;
+}
+
+//-------------------------------------------------------------------------------------
+void Parallel::parallelFor(size_t counts, ForFunction func)
+{
+	if (counts == 0) return;
+
+	size_t threadCounts = MathUtil::min2(getThreadCounts(), counts);
+	if (threadCounts <= 1) {
+		for (size_t i = 0; i < counts; i++) func(i);
+		return;
+	}
+
+	//every thread fetch next job from a shared counter, so uneven jobs are balanced
+	std::atomic<size_t> next(0);
+	auto worker = [&next, counts, &func]() {
+		for (size_t i = next.fetch_add(1); i < counts; i = next.fetch_add(1)) {
+			func(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCounts - 1);
+	for (size_t i = 0; i < threadCounts - 1; i++) {
+		threads.push_back(std::thread(worker));
+	}
+	//current thread works too
+	worker();
+
+	for (std::thread& t : threads) {
+		t.join();
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Parallel::parallelForTiles(int32_t width, int32_t height, int32_t tileSize, TileFunction func)
+{
+	assert(tileSize > 0);
+	if (width <= 0 || height <= 0) return;
+
+	int32_t widthInTiles = (width + tileSize - 1) / tileSize;
+	int32_t heightInTiles = (height + tileSize - 1) / tileSize;
+
+	parallelFor((size_t)(widthInTiles*heightInTiles), [width, height, tileSize, widthInTiles, &func](size_t index) {
+		int32_t x0 = ((int32_t)index % widthInTiles) * tileSize;
+		int32_t y0 = ((int32_t)index / widthInTiles) * tileSize;
+
+		func(x0, y0, MathUtil::min2(x0 + tileSize, width), MathUtil::min2(y0 + tileSize, height));
+	});
+}
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+namespace davinci
+{
+
+class Parallel
+{
+public:
+	//call func(index) for index in [0, counts) on all hardware threads
+	typedef std::function<void(size_t index)> ForFunction;
+	static void parallelFor(size_t counts, ForFunction func);
+
+	//split a width*height surface into tiles and call func(x0, y0, x1, y1) for each tile in parallel, 
+	//x1 and y1 are exclusive
+	typedef std::function<void(int32_t x0, int32_t y0, int32_t x1, int32_t y1)> TileFunction;
+	static void parallelForTiles(int32_t width, int32_t height, int32_t tileSize, TileFunction func);
+
+	//counts of worker threads
+	static size_t getThreadCounts(void);
+};
+
+}
@@ -16,41 +16,64 @@ public:
 		m_width = width;
 		m_height = height;
 		m_pixelBuffer.resize((size_t)(width*height));
+		m_pixels = &(m_pixelBuffer[0]);
 		clear(pixel);
 	}
 
+	//pixels in memory owned by caller(eg. transient surface of RenderGraph), at least getMemorySize bytes
+	//and must outlive the buffer
+	void init(int width, int height, const T& pixel, uint8_t* storage) {
+		assert(width > 0 && width < 0xFFFF);
+		assert(height > 0 && height < 0xFFFF);
+
+		m_width = width;
+		m_height = height;
+		std::vector<T>().swap(m_pixelBuffer);
+		m_pixels = (T*)storage;
+		std::uninitialized_fill(m_pixels, m_pixels + width*height, pixel);
+	}
+
 	void clear(const T& pixel) {
-		std::fill(m_pixelBuffer.begin(), m_pixelBuffer.end(), pixel);
+		std::fill(m_pixels, m_pixels + m_width*m_height, pixel);
+	}
+
+	//bytes of storage, rounded up so the next buffer in the same storage stays aligned
+	static size_t getMemorySize(int width, int height) {
+		return ((size_t)(width*height)*sizeof(T) + 15) & ~(size_t)15;
 	}
 
 	void setPixel(int32_t x, int32_t y, const T& pixel) {
 		assert(x >= 0 && x < m_width);
 		assert(y >= 0 && y < m_height);
 
-		m_pixelBuffer[(size_t)(y*m_width + x)] = pixel;
+		m_pixels[(size_t)(y*m_width + x)] = pixel;
 	}
 
-	const T& getPixel(int32_t x, int32_t y) {
+	const T& getPixel(int32_t x, int32_t y) const {
 		assert(x >= 0 && x < m_width);
 		assert(y >= 0 && y < m_height);
 
-		return m_pixelBuffer[(size_t)(y*m_width + x)];
+		return m_pixels[(size_t)(y*m_width + x)];
 	}
 
 	const T* ptr(void) const {
-		return &(m_pixelBuffer[0]);
+		return m_pixels;
+	}
+	T* ptr(void) {
+		return m_pixels;
 	}
 
 	int32_t getWidth(void) const { return m_width; }
 	int32_t getHeight(void) const { return m_height; }
 
 protected:
-	std::vector<T> m_pixelBuffer;
+	std::vector<T> m_pixelBuffer;	//empty if pixels are in external storage
+	T* m_pixels;
 	int32_t m_width;
 	int32_t m_height;
 
 public:
-	PixelBuffer() : m_width(0), m_height(0) { }
+	PixelBuffer() : m_pixels(nullptr), m_width(0), m_height(0) { }
 };
 
 
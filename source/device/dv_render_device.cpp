@@ -14,4 +14,21 @@ DeviceBufferPtr RenderDevice::createDeviceBuffer(size_t size) const
 	return deviceBuffer;
 }
 
+//-------------------------------------------------------------------------------------
+DeviceBufferPtr RenderDevice::reuseDeviceBuffer(DeviceBufferPtr buffer, size_t size) const
+{
+	if (buffer != nullptr && buffer->size() >= size) return buffer;
+
+	return createDeviceBuffer(size);
+}
+
+//-------------------------------------------------------------------------------------
+DeviceBufferPtr RenderDevice::wrapDeviceBuffer(void* ptr, size_t size) const
+{
+	DeviceBufferPtr deviceBuffer = std::make_shared<DeviceBuffer>();
+	deviceBuffer->wrap(ptr, size);
+
+	return deviceBuffer;
+}
+
 }
\ No newline at end of file
@@ -9,6 +9,10 @@ class RenderDevice
 {
 public:
 	DeviceBufferPtr createDeviceBuffer(size_t size) const;
+	//return the buffer if it's big enough, otherwise create a new one
+	DeviceBufferPtr reuseDeviceBuffer(DeviceBufferPtr buffer, size_t size) const;
+	//device buffer on caller-owned memory, no copy
+	DeviceBufferPtr wrapDeviceBuffer(void* ptr, size_t size) const;
 
 private:
 };
@@ -6,6 +6,9 @@ namespace davinci
 
 //-------------------------------------------------------------------------------------
 RenderTarget::RenderTarget()
+	: m_width(0)
+	, m_height(0)
+	, m_shadingRateImage(nullptr)
 {
 }
 
@@ -15,7 +18,22 @@ void RenderTarget::init(int width, int height)
 	m_width = width;
 	m_height = height;
 	m_colorBuffer.init(width, height, fVector4::BLACK);
-	m_depthBuffer.init(width, height, std::numeric_limits<float>::max());
+	m_depthBuffer.init(width, height);
+}
+
+//-------------------------------------------------------------------------------------
+void RenderTarget::init(int width, int height, uint8_t* storage)
+{
+	m_width = width;
+	m_height = height;
+	m_colorBuffer.init(width, height, fVector4::BLACK, storage);
+	m_depthBuffer.init(width, height, storage + PixelBuffer<fVector4>::getMemorySize(width, height));
+}
+
+//-------------------------------------------------------------------------------------
+size_t RenderTarget::getMemorySize(int width, int height)
+{
+	return PixelBuffer<fVector4>::getMemorySize(width, height) + DepthBuffer::getMemorySize(width, height);
 }
 
 //-------------------------------------------------------------------------------------
@@ -23,11 +41,175 @@ void RenderTarget::setPixel(int32_t x, int32_t y, const fVector4& color, float d
 {
 	if (x < 0 || x >= m_width || y<0 || y>=m_height) return;
 
-	if (depth > m_depthBuffer.getPixel(x, y)) {
+	if (!m_depthBuffer.testAndSet(x, y, depth, CF_LESS_EQUAL)) {
 		return;
 	}
 	m_colorBuffer.setPixel(x, y, color);
-	m_depthBuffer.setPixel(x, y, depth);
+}
+
+//-------------------------------------------------------------------------------------
+void RenderTarget::setPixel(int32_t x, int32_t y, const fVector4& color, float depth, const DepthStencilState& state)
+{
+	assert(!state.stencilEnable);
+	if (x < 0 || x >= m_width || y < 0 || y >= m_height) return;
+
+	if (state.depthEnable && !compareValue(state.depthFunc, depth, m_depthBuffer.getPixel(x, y))) return;
+	if (state.depthWrite) {
+		m_depthBuffer.setPixel(x, y, depth);
+	}
+	m_colorBuffer.setPixel(x, y, color);
+}
+
+//-------------------------------------------------------------------------------------
+void RenderTarget::fillBlock(int32_t x0, int32_t y0, uint32_t mask, const float* depth, const fVector4& color)
+{
+	enum { N = PixelBlock::PIXEL_COUNTS, S = PixelBlock::SIZE };
+
+	//block across the border of render target, pixel by pixel
+	if (x0 < 0 || y0 < 0 || x0 + S > m_width || y0 + S > m_height) {
+		for (int32_t i = 0; i < N; i++) {
+			if (mask & (1u << i)) setPixel(x0 + (i % S), y0 + (i / S), color, depth[i]);
+		}
+		return;
+	}
+
+	//depth test(CF_LESS_EQUAL) of all lanes at once, a plain loop the compiler can vectorise
+	float* depthBuffer = m_depthBuffer.ptr() + (size_t)(y0*m_width + x0);
+	uint32_t passed = 0;
+	for (int32_t i = 0; i < N; i++) {
+		passed |= (depth[i] <= depthBuffer[(i / S)*m_width + (i % S)] ? 1u : 0u) << i;
+	}
+	mask &= passed;
+
+	fVector4* colorBuffer = m_colorBuffer.ptr() + (size_t)(y0*m_width + x0);
+	for (int32_t i = 0; i < N; i++) {
+		if ((mask & (1u << i)) == 0) continue;
+
+		depthBuffer[(i / S)*m_width + (i % S)] = depth[i];
+		colorBuffer[(i / S)*m_width + (i % S)] = color;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+//blend factors of a block for channel c(3 is alpha), channels are stored as [channel][pixel], 
+//each case is a plain loop over the pixels so the compiler can vectorise it
+static inline void _blendFactor(BlendFactor factor, const float src[4][PixelBlock::PIXEL_COUNTS], const float dest[4][PixelBlock::PIXEL_COUNTS], int32_t c, float* out)
+{
+	enum { N = PixelBlock::PIXEL_COUNTS };
+
+	switch (factor) {
+	case BF_ZERO:			for (int32_t i = 0; i < N; i++) out[i] = 0.f; break;
+	case BF_ONE:			for (int32_t i = 0; i < N; i++) out[i] = 1.f; break;
+	case BF_SRC_COLOR:		for (int32_t i = 0; i < N; i++) out[i] = src[c][i]; break;
+	case BF_INV_SRC_COLOR:	for (int32_t i = 0; i < N; i++) out[i] = 1.f - src[c][i]; break;
+	case BF_SRC_ALPHA:		for (int32_t i = 0; i < N; i++) out[i] = src[3][i]; break;
+	case BF_INV_SRC_ALPHA:	for (int32_t i = 0; i < N; i++) out[i] = 1.f - src[3][i]; break;
+	case BF_DEST_COLOR:		for (int32_t i = 0; i < N; i++) out[i] = dest[c][i]; break;
+	case BF_INV_DEST_COLOR:	for (int32_t i = 0; i < N; i++) out[i] = 1.f - dest[c][i]; break;
+	case BF_DEST_ALPHA:		for (int32_t i = 0; i < N; i++) out[i] = dest[3][i]; break;
+	case BF_INV_DEST_ALPHA:	for (int32_t i = 0; i < N; i++) out[i] = 1.f - dest[3][i]; break;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+static inline void _blendOp(BlendOp op, const float* src, const float* srcFactor, const float* dest, const float* destFactor, float* out)
+{
+	enum { N = PixelBlock::PIXEL_COUNTS };
+
+	switch (op) {
+	case BO_ADD:			for (int32_t i = 0; i < N; i++) out[i] = src[i] * srcFactor[i] + dest[i] * destFactor[i]; break;
+	case BO_SUBTRACT:		for (int32_t i = 0; i < N; i++) out[i] = src[i] * srcFactor[i] - dest[i] * destFactor[i]; break;
+	case BO_REV_SUBTRACT:	for (int32_t i = 0; i < N; i++) out[i] = dest[i] * destFactor[i] - src[i] * srcFactor[i]; break;
+	case BO_MIN:			for (int32_t i = 0; i < N; i++) out[i] = MathUtil::min2(src[i], dest[i]); break;
+	case BO_MAX:			for (int32_t i = 0; i < N; i++) out[i] = MathUtil::max2(src[i], dest[i]); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+bool RenderTarget::earlyTest(int32_t x, int32_t y, float depth, const DepthStencilState& state) const
+{
+	if (x < 0 || x >= m_width || y < 0 || y >= m_height) return false;
+	//rejected pixels must update stencil, leave them to the full test
+	if (!state.isFailOpKeep()) return true;
+
+	if (state.stencilEnable) {
+		uint8_t stencil = m_depthBuffer.getStencil(x, y);
+		if (!compareValue(state.stencilFunc, (uint8_t)(state.stencilRef & state.stencilReadMask), (uint8_t)(stencil & state.stencilReadMask))) return false;
+	}
+	return !state.depthEnable || compareValue(state.depthFunc, depth, m_depthBuffer.getPixel(x, y));
+}
+
+//-------------------------------------------------------------------------------------
+void RenderTarget::blendBlock(const PixelBlock& block, const BlendState& blendState, const DepthStencilState& depthStencilState)
+{
+	enum { N = PixelBlock::PIXEL_COUNTS };
+	const DepthStencilState& ds = depthStencilState;
+
+	//depth/stencil test, pixels of one block never overlap
+	uint32_t mask = 0;
+	for (int32_t i = 0; i < N; i++) {
+		if ((block.mask & (1u << i)) == 0) continue;
+
+		int32_t x = block.x0 + (i % PixelBlock::SIZE), y = block.y0 + (i / PixelBlock::SIZE);
+		if (x < 0 || x >= m_width || y < 0 || y >= m_height) continue;
+
+		bool depthPassed = !ds.depthEnable || compareValue(ds.depthFunc, block.depth[i], m_depthBuffer.getPixel(x, y));
+
+		if (ds.stencilEnable) {
+			uint8_t stencil = m_depthBuffer.getStencil(x, y);
+			bool stencilPassed = compareValue(ds.stencilFunc, (uint8_t)(ds.stencilRef & ds.stencilReadMask), (uint8_t)(stencil & ds.stencilReadMask));
+
+			StencilOp op = !stencilPassed ? ds.stencilFailOp : (!depthPassed ? ds.depthFailOp : ds.passOp);
+			if (op != SO_KEEP && ds.stencilWriteMask != 0) {
+				uint8_t result = DepthStencilState::applyStencilOp(op, stencil, ds.stencilRef);
+				m_depthBuffer.setStencil(x, y, (uint8_t)((stencil & ~ds.stencilWriteMask) | (result & ds.stencilWriteMask)));
+			}
+			if (!stencilPassed) continue;
+		}
+		if (!depthPassed) continue;
+
+		if (ds.depthWrite) {
+			m_depthBuffer.setPixel(x, y, block.depth[i]);
+		}
+		mask |= (1u << i);
+	}
+	if (mask == 0) return;
+
+	float result[4][N];
+	if (blendState.blendEnable) {
+		//to [channel][pixel], lanes of rejected pixels are blended and dropped
+		float src[4][N], dest[4][N];
+		for (int32_t i = 0; i < N; i++) {
+			fVector4 destColor = fVector4::ZERO;
+			if (mask & (1u << i)) {
+				destColor = m_colorBuffer.getPixel(block.x0 + (i % PixelBlock::SIZE), block.y0 + (i / PixelBlock::SIZE));
+			}
+			for (int32_t c = 0; c < 4; c++) {
+				src[c][i] = block.color[i][(size_t)c];
+				dest[c][i] = destColor[(size_t)c];
+			}
+		}
+
+		float srcFactor[N], destFactor[N];
+		for (int32_t c = 0; c < 4; c++) {
+			bool alpha = (c == 3);
+			_blendFactor(alpha ? blendState.srcBlendAlpha : blendState.srcBlend, src, dest, c, srcFactor);
+			_blendFactor(alpha ? blendState.destBlendAlpha : blendState.destBlend, src, dest, c, destFactor);
+			_blendOp(alpha ? blendState.blendOpAlpha : blendState.blendOp, src[c], srcFactor, dest[c], destFactor, result[c]);
+		}
+	}
+	else {
+		for (int32_t i = 0; i < N; i++) {
+			for (int32_t c = 0; c < 4; c++) {
+				result[c][i] = block.color[i][(size_t)c];
+			}
+		}
+	}
+
+	for (int32_t i = 0; i < N; i++) {
+		if ((mask & (1u << i)) == 0) continue;
+		m_colorBuffer.setPixel(block.x0 + (i % PixelBlock::SIZE), block.y0 + (i / PixelBlock::SIZE), fVector4(result[0][i], result[1][i], result[2][i], result[3][i]));
+	}
 }
 
 }
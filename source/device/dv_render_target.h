@@ -3,26 +3,74 @@
 #include "dv_prerequisites.h"
 
 #include "dv_pixel_buffer.h"
+#include "dv_depth_buffer.h"
+#include "dv_shading_rate_image.h"
+#include "dv_blend_state.h"
+#include "dv_depth_stencil_state.h"
 
 namespace davinci
 {
 
+//4x4 pixels sent to blend unit at a time, bit i of mask is pixel(x0 + i%4, y0 + i/4)
+struct PixelBlock
+{
+	enum { SIZE = 4, PIXEL_COUNTS = SIZE*SIZE };
+
+	int32_t x0, y0;
+	uint32_t mask;
+	fVector4 color[PIXEL_COUNTS];
+	float depth[PIXEL_COUNTS];
+};
+
 class RenderTarget
 {
 public:
 	void init(int width, int height);
+	//color, depth and stencil in storage of getMemorySize bytes owned by caller
+	void init(int width, int height, uint8_t* storage);
+	static size_t getMemorySize(int width, int height);
+	//default depth/stencil state(DepthStencilState::makeDefault) without blending
 	void setPixel(int32_t x, int32_t y, const fVector4& color, float depth);
+	//depth test and write of state, stencil is disabled and without blending
+	void setPixel(int32_t x, int32_t y, const fVector4& color, float depth, const DepthStencilState& state);
+	//one color for the covered pixels of a 4x4 block(mask as PixelBlock), default depth/stencil state without blending
+	void fillBlock(int32_t x0, int32_t y0, uint32_t mask, const float* depth, const fVector4& color);
+	//blend unit, depth/stencil test(and write) then blend a block of pixels with render target
+	void blendBlock(const PixelBlock& block, const BlendState& blendState, const DepthStencilState& depthStencilState);
+
+	//early depth/stencil test before pixel shader, read only. 
+	//pixels passed still go through the full test when they are written
+	bool earlyTest(int32_t x, int32_t y, float depth) const {
+		if (x < 0 || x >= m_width || y < 0 || y >= m_height) return false;
+		return depth <= m_depthBuffer.getPixel(x, y);
+	}
+	bool earlyTest(int32_t x, int32_t y, float depth, const DepthStencilState& state) const;
+
+	//screen-space shading rate, combined with rate of draw by the coarser one, null to disable
+	void setShadingRateImage(const ShadingRateImage* shadingRateImage) {
+		m_shadingRateImage = shadingRateImage;
+	}
+	const ShadingRateImage* getShadingRateImage(void) const {
+		return m_shadingRateImage;
+	}
+	ShadingRate getShadingRate(int32_t x, int32_t y, ShadingRate drawRate) const {
+		if (m_shadingRateImage == nullptr) return drawRate;
+		return MathUtil::max2(drawRate, m_shadingRateImage->getRate(x, y));
+	}
 
 	int32_t getWidth(void) const { return m_width; }
 	int32_t getHeight(void) const { return m_height; }
 	const PixelBuffer<fVector4>& getColorBuffer(void) const { return m_colorBuffer; }
-	const PixelBuffer<float>& getDepthBuffer(void) const { return m_depthBuffer; }
+	PixelBuffer<fVector4>& getColorBuffer(void) { return m_colorBuffer; }
+	const DepthBuffer& getDepthBuffer(void) const { return m_depthBuffer; }
+	DepthBuffer& getDepthBuffer(void) { return m_depthBuffer; }
 
 private:
 	int32_t m_width;
 	int32_t m_height;
 	PixelBuffer<fVector4> m_colorBuffer;
-	PixelBuffer<float> m_depthBuffer;
+	DepthBuffer m_depthBuffer;
+	const ShadingRateImage* m_shadingRateImage;
 
 public:
 	RenderTarget();
@@ -0,0 +1,166 @@
+#include "dv_precompiled.h"
+#include "dv_render_target_set.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+RenderTargetSet::RenderTargetSet()
+	: m_width(0)
+	, m_height(0)
+	, m_targetCounts(0)
+{
+}
+
+//-------------------------------------------------------------------------------------
+size_t RenderTargetSet::getPixelSize(PixelFormat format)
+{
+	switch (format) {
+	case PF_FLOAT32_RGBA: return sizeof(float) * 4;
+	case PF_FLOAT32_RGB: return sizeof(float) * 3;
+	case PF_FLOAT32_RG: return sizeof(float) * 2;
+	case PF_FLOAT32_R: return sizeof(float);
+	case PF_UINT8_RGBA: return sizeof(uint32_t);
+	case PF_UINT32_R: return sizeof(uint32_t);
+	default: return 0;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void RenderTargetSet::_setFormats(int width, int height, const std::vector<PixelFormat>& formats)
+{
+	assert(formats.size() > 0 && formats.size() <= MAX_TARGET_COUNTS);
+
+	m_width = width;
+	m_height = height;
+	m_targetCounts = 0;
+	for (PixelFormat format : formats) {
+		Target& target = m_targets[m_targetCounts++];
+
+		target.format = format;
+		target.pixelSize = getPixelSize(format);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void RenderTargetSet::init(int width, int height, const std::vector<PixelFormat>& formats)
+{
+	_setFormats(width, height, formats);
+	for (int32_t i = 0; i < m_targetCounts; i++) {
+		Target& target = m_targets[i];
+
+		target.pixels.assign((size_t)(width*height)*target.pixelSize, 0);
+		target.data = &(target.pixels[0]);
+	}
+	m_depthBuffer.init(width, height);
+}
+
+//-------------------------------------------------------------------------------------
+void RenderTargetSet::init(int width, int height, const std::vector<PixelFormat>& formats, uint8_t* storage)
+{
+	_setFormats(width, height, formats);
+	for (int32_t i = 0; i < m_targetCounts; i++) {
+		Target& target = m_targets[i];
+
+		std::vector<uint8_t>().swap(target.pixels);
+		target.data = storage;
+		memset(target.data, 0, (size_t)(width*height)*target.pixelSize);
+		storage += _getTargetMemorySize(width, height, target.format);
+	}
+	m_depthBuffer.init(width, height, storage);
+}
+
+//-------------------------------------------------------------------------------------
+size_t RenderTargetSet::getMemorySize(int width, int height, const std::vector<PixelFormat>& formats)
+{
+	size_t size = DepthBuffer::getMemorySize(width, height);
+	for (PixelFormat format : formats) {
+		size += _getTargetMemorySize(width, height, format);
+	}
+	return size;
+}
+
+//-------------------------------------------------------------------------------------
+static inline uint32_t _toUnorm8(float value)
+{
+	return (uint32_t)(MathUtil::saturate(value)*255.f + 0.5f);
+}
+
+//-------------------------------------------------------------------------------------
+void RenderTargetSet::setPixel(int32_t x, int32_t y, const fVector4* outputs, float depth)
+{
+	if (x < 0 || x >= m_width || y < 0 || y >= m_height) return;
+
+	if (!m_depthBuffer.testAndSet(x, y, depth, CF_LESS_EQUAL)) {
+		return;
+	}
+
+	size_t pixelIndex = (size_t)(y*m_width + x);
+	for (int32_t i = 0; i < m_targetCounts; i++) {
+		Target& target = m_targets[i];
+		const fVector4& output = outputs[i];
+		uint8_t* pixel = target.data + pixelIndex*target.pixelSize;
+
+		switch (target.format) {
+		case PF_FLOAT32_RGBA:
+		case PF_FLOAT32_RGB:
+		case PF_FLOAT32_RG:
+		case PF_FLOAT32_R:
+			memcpy(pixel, &output, target.pixelSize);
+			break;
+		case PF_UINT8_RGBA:
+		{
+			uint32_t packed = _toUnorm8(output.x) | (_toUnorm8(output.y) << 8) | (_toUnorm8(output.z) << 16) | (_toUnorm8(output.w) << 24);
+			memcpy(pixel, &packed, sizeof(packed));
+		}
+		break;
+		case PF_UINT32_R:
+		{
+			uint32_t value = (uint32_t)MathUtil::max2(0.f, output.x);
+			memcpy(pixel, &value, sizeof(value));
+		}
+		break;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+fVector4 RenderTargetSet::getPixel(int32_t index, int32_t x, int32_t y) const
+{
+	assert(index >= 0 && index < m_targetCounts);
+	assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
+
+	const Target& target = m_targets[index];
+	const uint8_t* pixel = target.data + (size_t)(y*m_width + x)*target.pixelSize;
+
+	fVector4 result(0.f, 0.f, 0.f, 0.f);
+	switch (target.format) {
+	case PF_FLOAT32_RGBA:
+	case PF_FLOAT32_RGB:
+	case PF_FLOAT32_RG:
+	case PF_FLOAT32_R:
+	{
+		float channels[4] = { 0.f, 0.f, 0.f, 0.f };
+		memcpy(channels, pixel, target.pixelSize);
+		result = fVector4(channels[0], channels[1], channels[2], channels[3]);
+	}
+		break;
+	case PF_UINT8_RGBA:
+	{
+		uint32_t packed;
+		memcpy(&packed, pixel, sizeof(packed));
+		result = fVector4((packed & 0xFF) / 255.f, ((packed >> 8) & 0xFF) / 255.f, ((packed >> 16) & 0xFF) / 255.f, (packed >> 24) / 255.f);
+	}
+	break;
+	case PF_UINT32_R:
+	{
+		uint32_t value;
+		memcpy(&value, pixel, sizeof(value));
+		result.x = (float)value;
+	}
+	break;
+	}
+	return result;
+}
+
+}
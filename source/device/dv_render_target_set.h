@@ -0,0 +1,69 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+#include "dv_depth_buffer.h"
+
+namespace davinci
+{
+
+//Multiple render targets written by one pixel shader invocation(PixelShader::psMultiTarget), 
+//sharing one depth buffer. Pixel shader always outputs fVector4, it is converted to the format of each target
+//(PF_UINT8_RGBA is saturated, PF_UINT32_R takes x as an integer eg. object id)
+class RenderTargetSet
+{
+public:
+	enum { MAX_TARGET_COUNTS = 4 };
+
+	//formats of target 0, 1, ..., at most MAX_TARGET_COUNTS
+	void init(int width, int height, const std::vector<PixelFormat>& formats);
+	//all targets and depth in storage of getMemorySize bytes owned by caller
+	void init(int width, int height, const std::vector<PixelFormat>& formats, uint8_t* storage);
+	static size_t getMemorySize(int width, int height, const std::vector<PixelFormat>& formats);
+	//depth test CF_LESS_EQUAL, outputs[i] is stored to target i
+	void setPixel(int32_t x, int32_t y, const fVector4* outputs, float depth);
+	//early depth test before pixel shader
+	bool earlyTest(int32_t x, int32_t y, float depth) const {
+		if (x < 0 || x >= m_width || y < 0 || y >= m_height) return false;
+		return depth <= m_depthBuffer.getPixel(x, y);
+	}
+
+	//pixel of target converted back to fVector4
+	fVector4 getPixel(int32_t index, int32_t x, int32_t y) const;
+	//raw pixels of target, packed in its format
+	const uint8_t* ptr(int32_t index) const { return m_targets[index].data; }
+
+	int32_t getTargetCounts(void) const { return m_targetCounts; }
+	PixelFormat getFormat(int32_t index) const { return m_targets[index].format; }
+	int32_t getWidth(void) const { return m_width; }
+	int32_t getHeight(void) const { return m_height; }
+	const DepthBuffer& getDepthBuffer(void) const { return m_depthBuffer; }
+
+	static size_t getPixelSize(PixelFormat format);
+
+private:
+	struct Target
+	{
+		PixelFormat format;
+		size_t pixelSize;
+		std::vector<uint8_t> pixels;	//empty if pixels are in external storage
+		uint8_t* data;
+	};
+
+	void _setFormats(int width, int height, const std::vector<PixelFormat>& formats);
+	static size_t _getTargetMemorySize(int width, int height, PixelFormat format) {
+		return ((size_t)(width*height)*getPixelSize(format) + 15) & ~(size_t)15;
+	}
+
+	int32_t m_width;
+	int32_t m_height;
+	int32_t m_targetCounts;
+	Target m_targets[MAX_TARGET_COUNTS];
+	DepthBuffer m_depthBuffer;
+
+public:
+	RenderTargetSet();
+	~RenderTargetSet() {}
+};
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+#include "dv_pixel_buffer.h"
+
+namespace davinci
+{
+
+//Screen-space shading rate of variable-rate shading, one texel for each 4x4 pixels
+class ShadingRateImage : public PixelBuffer<ShadingRate>
+{
+public:
+	enum { TEXEL_SIZE = 4 };
+
+	//size of render target in pixels
+	void init(int width, int height, ShadingRate rate = SR_1X1) {
+		PixelBuffer<ShadingRate>::init((width + TEXEL_SIZE - 1) / TEXEL_SIZE, (height + TEXEL_SIZE - 1) / TEXEL_SIZE, rate);
+	}
+
+	//rate of a pixel
+	ShadingRate getRate(int32_t x, int32_t y) const {
+		return getPixel(x / TEXEL_SIZE, y / TEXEL_SIZE);
+	}
+};
+
+}
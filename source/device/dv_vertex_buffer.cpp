@@ -13,21 +13,63 @@ void VertexBuffer::build(RenderDevice* device, const VertexDesc& desc, float* ve
 	assert(vertices && verticesCounts>0);
 
 	m_vertexDesc = desc;
-	m_vertices = device->createDeviceBuffer(desc.vertexSize() * verticesCounts * sizeof(float));
+	m_vertices[0] = device->createDeviceBuffer(desc.vertexSize() * verticesCounts * sizeof(float));
+	m_vertices[1] = nullptr;
+	m_front = 0;
 
-	memcpy(m_vertices->ptr(0), vertices, desc.vertexSize() * verticesCounts * sizeof(float));
+	memcpy(m_vertices[0]->ptr(0), vertices, desc.vertexSize() * verticesCounts * sizeof(float));
+}
+
+//-------------------------------------------------------------------------------------
+void VertexBuffer::buildDynamic(RenderDevice* device, const VertexDesc& desc, size_t verticesCounts)
+{
+	assert(verticesCounts>0);
+
+	m_vertexDesc = desc;
+	m_vertices[0] = device->createDeviceBuffer(desc.vertexSize() * verticesCounts * sizeof(float));
+	m_vertices[1] = device->createDeviceBuffer(desc.vertexSize() * verticesCounts * sizeof(float));
+	m_front = 0;
+}
+
+//-------------------------------------------------------------------------------------
+void VertexBuffer::wrap(RenderDevice* device, const VertexDesc& desc, float* vertices, size_t verticesCounts)
+{
+	assert(vertices && verticesCounts>0);
+
+	m_vertexDesc = desc;
+	m_vertices[0] = device->wrapDeviceBuffer(vertices, desc.vertexSize() * verticesCounts * sizeof(float));
+	m_vertices[1] = nullptr;
+	m_front = 0;
+}
+
+//-------------------------------------------------------------------------------------
+float* VertexBuffer::map(void)
+{
+	assert(!m_mapped);
+	m_mapped = true;
+
+	return (float*)(m_vertices[isDynamic() ? 1 - m_front : m_front]->ptr(0));
+}
+
+//-------------------------------------------------------------------------------------
+void VertexBuffer::unmap(void)
+{
+	assert(m_mapped);
+	m_mapped = false;
+
+	if (isDynamic()) m_front = 1 - m_front;
 }
 
 //-------------------------------------------------------------------------------------
 size_t VertexBuffer::counts(void) const 
 { 
-	return m_vertices->size() / vertexSize(); 
+	return m_vertices[m_front]->size() / (vertexSize() * sizeof(float));
 }
 
 //-------------------------------------------------------------------------------------
 const float* VertexBuffer::ptr(size_t index) const 
 {
-	return (const float*)(m_vertices->ptr(index*vertexSize() * sizeof(float)));
+	return (const float*)(m_vertices[m_front]->ptr(index*vertexSize() * sizeof(float)));
 }
 
 }
@@ -12,6 +12,19 @@ class VertexBuffer : noncopyable
 public:
 	//build vertex buffer
 	void build(RenderDevice* device, const VertexDesc& desc, float* vertices, size_t verticesCounts);
+	//build double buffered vertex buffer, filled by map/unmap every frame
+	void buildDynamic(RenderDevice* device, const VertexDesc& desc, size_t verticesCounts);
+	//use caller-owned vertices without copy, the memory must outlive this buffer
+	void wrap(RenderDevice* device, const VertexDesc& desc, float* vertices, size_t verticesCounts);
+
+	//get the buffer to write, for dynamic buffer it's the one not being read by pipeline,
+	//and it still holds the data of two frames ago
+	float* map(void);
+	//publish the data written after map
+	void unmap(void);
+
+	//is double buffered
+	bool isDynamic(void) const { return m_vertices[1] != nullptr; }
 
 	//get vertex counts
 	size_t counts(void) const;
@@ -27,10 +40,12 @@ public:
 
 private:
 	VertexDesc m_vertexDesc;
-	DeviceBufferPtr m_vertices;
+	DeviceBufferPtr m_vertices[2];
+	size_t m_front;		//index of the buffer read by pipeline
+	bool m_mapped;
 
 public:
-	VertexBuffer() {}
+	VertexBuffer() : m_front(0), m_mapped(false) {}
 	~VertexBuffer() {}
 };
 
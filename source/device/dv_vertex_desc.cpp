@@ -8,6 +8,7 @@ namespace davinci
 VertexDesc::VertexDesc() 
 	: m_vertexSize(0)
 	, m_currentOffset(0) 
+	, m_elementMask(0)
 {
 	m_elementOffset.resize((size_t)VertexElementType::VET_COUNTS, -1);
 }
@@ -16,6 +17,7 @@ VertexDesc::VertexDesc()
 void VertexDesc::addElement(VertexElementType type, VertexElementFormat format)
 {
 	m_elementOffset[(size_t)type] = (int32_t)m_currentOffset;
+	m_elementMask |= (1u << (uint32_t)type);
 
 	Element element;
 	element.type = type;
@@ -19,6 +19,8 @@ public:
 	const OffsetData& getElementOffset(void) const {
 		return m_elementOffset;
 	}
+	//bit (1<<type) is set for each element in this desc
+	uint32_t getElementMask(void) const { return m_elementMask; }
 	//the size (in number of floats) of each vertex
 	size_t vertexSize(void) const { return m_vertexSize; }
 	//utility function: get size(in number of floats) of a element 
@@ -37,6 +39,7 @@ private:
 	size_t		m_vertexSize;
 	size_t		m_currentOffset;
 	OffsetData	m_elementOffset;
+	uint32_t	m_elementMask;
 
 public:
 	VertexDesc();
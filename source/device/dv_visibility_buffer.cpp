@@ -0,0 +1,42 @@
+#include "dv_precompiled.h"
+#include "dv_visibility_buffer.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+VisibilityBuffer::VisibilityBuffer()
+	: m_width(0)
+	, m_height(0)
+{
+}
+
+//-------------------------------------------------------------------------------------
+void VisibilityBuffer::init(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_idBuffer.init(width, height, INVALID_ID);
+	m_depthBuffer.init(width, height, std::numeric_limits<float>::max());
+}
+
+//-------------------------------------------------------------------------------------
+void VisibilityBuffer::clear(void)
+{
+	m_idBuffer.clear(INVALID_ID);
+	m_depthBuffer.clear(std::numeric_limits<float>::max());
+}
+
+//-------------------------------------------------------------------------------------
+void VisibilityBuffer::setPixel(int32_t x, int32_t y, uint32_t id, float depth)
+{
+	if (x < 0 || x >= m_width || y<0 || y >= m_height) return;
+
+	if (depth > m_depthBuffer.getPixel(x, y)) {
+		return;
+	}
+	m_idBuffer.setPixel(x, y, id);
+	m_depthBuffer.setPixel(x, y, depth);
+}
+
+}
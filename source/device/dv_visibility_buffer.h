@@ -0,0 +1,51 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+#include "dv_pixel_buffer.h"
+
+namespace davinci
+{
+
+//Render target of visibility buffer rendering, only 32bit draw/triangle id and depth for each pixel
+class VisibilityBuffer
+{
+public:
+	enum {
+		TRIANGLE_ID_BITS = 20,
+		MAX_TRIANGLE_COUNTS = (1 << TRIANGLE_ID_BITS) - 1,
+		MAX_DRAW_COUNTS = 1 << (32 - TRIANGLE_ID_BITS),
+	};
+	static const uint32_t INVALID_ID = 0xFFFFFFFF;
+
+	//draw id in high bits, triangle id in low bits
+	static uint32_t makeID(uint32_t drawID, uint32_t triangleID) {
+		assert(drawID < MAX_DRAW_COUNTS && triangleID < MAX_TRIANGLE_COUNTS);
+		return (drawID << TRIANGLE_ID_BITS) | triangleID;
+	}
+	static uint32_t getDrawID(uint32_t id) { return id >> TRIANGLE_ID_BITS; }
+	static uint32_t getTriangleID(uint32_t id) { return id & ((1u << TRIANGLE_ID_BITS) - 1); }
+
+public:
+	void init(int width, int height);
+	//all pixels back to INVALID_ID and far depth
+	void clear(void);
+	void setPixel(int32_t x, int32_t y, uint32_t id, float depth);
+
+	int32_t getWidth(void) const { return m_width; }
+	int32_t getHeight(void) const { return m_height; }
+	const PixelBuffer<uint32_t>& getIDBuffer(void) const { return m_idBuffer; }
+	const PixelBuffer<float>& getDepthBuffer(void) const { return m_depthBuffer; }
+
+private:
+	int32_t m_width;
+	int32_t m_height;
+	PixelBuffer<uint32_t> m_idBuffer;
+	PixelBuffer<float> m_depthBuffer;
+
+public:
+	VisibilityBuffer();
+	~VisibilityBuffer() {}
+};
+
+}
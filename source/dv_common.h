@@ -44,6 +44,71 @@ enum PrimitiveType
 	PT_TRIANGLE_STRIP,
 };
 
+//triangle list and strip are both assembled into triangles by primitive assembler
+inline bool isTrianglePrimitive(PrimitiveType primitiveType)
+{
+	return primitiveType == PT_TRIANGLE_LIST || primitiveType == PT_TRIANGLE_STRIP;
+}
+
+//line strip and triangle strip, which can be cut by the restart index
+inline bool isStripPrimitive(PrimitiveType primitiveType)
+{
+	return primitiveType == PT_LINE_STRIP || primitiveType == PT_TRIANGLE_STRIP;
+}
+
+enum IndexFormat
+{
+	IF_UINT16,
+	//for meshes with more than 65535 vertices
+	IF_UINT32,
+};
+
+enum CullMode
+{
+	//draw all triangles
+	CM_NONE,
+	//cull clockwise triangles(in window coordinates, y axis up)
+	CM_CW,
+	//cull counter-clockwise triangles, default cull mode
+	CM_CCW,
+};
+
+//size of coarse pixel of variable-rate shading, value is log2 of the size
+enum ShadingRate
+{
+	SR_1X1 = 0,
+	SR_2X2 = 1,
+	SR_4X4 = 2,
+};
+
+enum CompareFunc
+{
+	CF_NEVER,
+	CF_LESS,
+	CF_EQUAL,
+	CF_LESS_EQUAL,
+	CF_GREATER,
+	CF_NOT_EQUAL,
+	CF_GREATER_EQUAL,
+	CF_ALWAYS,
+};
+
+//return true if 'value func reference' passed, eg. value <= reference for CF_LESS_EQUAL
+template<typename T>
+inline bool compareValue(CompareFunc func, const T& value, const T& reference)
+{
+	switch (func) {
+	case CF_NEVER: return false;
+	case CF_LESS: return value < reference;
+	case CF_EQUAL: return value == reference;
+	case CF_LESS_EQUAL: return value <= reference;
+	case CF_GREATER: return value > reference;
+	case CF_NOT_EQUAL: return value != reference;
+	case CF_GREATER_EQUAL: return value >= reference;
+	default: return true;
+	}
+}
+
 enum PixelFormat
 {
 	//96-bit pixel format, 32 bits (float) for red, 32 bits (float) for green, 32 bits (float) for blue
@@ -54,6 +119,10 @@ enum PixelFormat
 	PF_FLOAT32_R,
 	/// 132-bit pixel format, 8 bits (float) for red, 8 bits (float) for green, 8 bits (float) for blue, 8 bits (float) for alpha
 	PF_UINT8_RGBA,
+	// 64-bit pixel format, 32 bits (float) for red, 32 bits (float) for green
+	PF_FLOAT32_RG,
+	// 32-bit pixel format, 32 bits (unsigned integer) for red
+	PF_UINT32_R,
 };
 
 }
@@ -8,6 +8,8 @@
 namespace davinci
 {
 class RenderQueue;
+class RenderGraph;
+class CommandList;
 class Renderable;
 class VertexShader;
 class PixelShader;
@@ -17,13 +19,27 @@ class RenderDevice;
 class VertexDesc;
 class VertexBuffer;
 class IndexBuffer;
+class InstanceBuffer;
 class Model;
 class Texture;
 class SceneObject;
 class Camera;
+class ShadowMap;
 class PrimitiveAfterAssember;
 class PrimitiveAfterVS;
 class RenderTarget;
+class RenderTargetSet;
+class GBuffer;
+struct GBufferPixel;
+class LightingShader;
+class VisibilityBuffer;
+class DepthBuffer;
+class ShadingRateImage;
+struct BlendState;
+struct DepthStencilState;
+struct PixelBlock;
+struct Light;
+class LightGrid;
 
 typedef std::shared_ptr<Renderable>				RenderablePtr;
 typedef std::shared_ptr<const Renderable>		ConstRenderablePtr;
@@ -38,6 +54,8 @@ typedef std::shared_ptr<VertexBuffer>			VertexBufferPtr;
 typedef std::shared_ptr<const VertexBuffer>		ConstVertexBufferPtr;
 typedef std::shared_ptr<IndexBuffer>			IndexBufferPtr;
 typedef std::shared_ptr<const IndexBuffer>		ConstIndexBufferPtr;
+typedef std::shared_ptr<InstanceBuffer>			InstanceBufferPtr;
+typedef std::shared_ptr<const InstanceBuffer>	ConstInstanceBufferPtr;
 typedef std::shared_ptr<Model>					ModelPtr;
 typedef std::shared_ptr<const Model>			ConstModelPtr;
 typedef std::shared_ptr<Texture>				TexturePtr;
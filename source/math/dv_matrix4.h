@@ -224,6 +224,8 @@ public:
 	static TMatrix4 lookatLH(const TVector3<T>& eye, const TVector3<T>& lookat, const TVector3<T>& up);
 	//return a left-handed perspective projection matrix based on a field of view.
 	static TMatrix4 perspectiveFovLH(T fov, T aspect, T zNear, T zFar);
+	//return a left-handed orthographic projection matrix, view volume is centered on z axis.
+	static TMatrix4 orthoLH(T width, T height, T zNear, T zFar);
 
 public:
 	static const TMatrix4 ZERO;
@@ -433,6 +435,23 @@ TMatrix4<T> TMatrix4<T>::perspectiveFovLH(T fov, T aspect, T zNear, T zFar)
 		0.f, 0.f, -range * zNear, 0.f);
 }
 
+//-------------------------------------------------------------------------------------
+template<typename T>
+TMatrix4<T> TMatrix4<T>::orthoLH(T width, T height, T zNear, T zFar)
+{
+	assert(!MathUtil::floatEqual(width, 0.f, 0.00001f));
+	assert(!MathUtil::floatEqual(height, 0.f, 0.00001f));
+	assert(!MathUtil::floatEqual(zNear, zFar, 0.00001f));
+
+	T range = 1.f / (zFar - zNear);
+
+	return TMatrix4<T>(
+		2.f / width, 0.f, 0.f, 0.f,
+		0.f, 2.f / height, 0.f, 0.f,
+		0.f, 0.f, range, 0.f,
+		0.f, 0.f, -range * zNear, 1.f);
+}
+
 typedef TMatrix4<float> fMatrix4;
 
 }
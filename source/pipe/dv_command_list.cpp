@@ -0,0 +1,133 @@
+#include "dv_precompiled.h"
+#include "dv_command_list.h"
+
+#include "dv_renderable.h"
+#include "dv_pipe_VS.h"
+#include "dv_pipe_PS.h"
+
+namespace davinci
+{
+
+//Renderable of one recorded draw
+class CommandRenderable : public Renderable
+{
+public:
+	void build(const RenderDevice* device, PrimitiveType primitiveType, const std::vector<ConstVertexBufferPtr>& vertexStreams, ConstIndexBufferPtr indexBuffer,
+		const fMatrix4& transform, ConstVertexShaderPtr vs, ConstPixelShaderPtr ps) {
+		m_primitiveType = primitiveType;
+		m_vertexStreams = vertexStreams;
+		m_indexBuffer = indexBuffer;
+		m_worldTransform = transform;
+		m_vs = vs;
+		m_ps = ps;
+		if (m_vsConstantBuffer == nullptr) m_vsConstantBuffer = std::make_shared<ConstantBuffer>(device);
+		if (m_psConstantBuffer == nullptr) m_psConstantBuffer = std::make_shared<ConstantBuffer>(device);
+	}
+
+	virtual size_t getVertexStreamCounts(void) const { return m_vertexStreams.size(); }
+	virtual ConstVertexBufferPtr getVertexStream(size_t index) const { return m_vertexStreams[index]; }
+	virtual ConstIndexBufferPtr getIndexBuffer(void) const { return m_indexBuffer; }
+
+private:
+	std::vector<ConstVertexBufferPtr> m_vertexStreams;
+	ConstIndexBufferPtr m_indexBuffer;
+};
+
+//-------------------------------------------------------------------------------------
+CommandList::CommandList(const RenderDevice* device)
+	: m_device(device)
+	, m_drawCounts(0)
+{
+	reset();
+}
+
+//-------------------------------------------------------------------------------------
+CommandList::~CommandList()
+{
+}
+
+//-------------------------------------------------------------------------------------
+void CommandList::reset(void)
+{
+	m_vs = nullptr;
+	m_ps = nullptr;
+	m_transform = fMatrix4::IDENTITY;
+	m_cullMode = CM_CCW;
+	m_shadingRate = SR_1X1;
+	m_blendState = BlendState::makeOpaque();
+	m_depthStencilState = DepthStencilState::makeDefault();
+	for (int32_t i = 0; i < ConstantBuffer::MAX_BUFFER_COUNTS; i++) {
+		m_vsConstants[i].clear();
+		m_psConstants[i].clear();
+	}
+	m_drawCounts = 0;
+}
+
+//-------------------------------------------------------------------------------------
+void CommandList::setShaders(ConstVertexShaderPtr vs, ConstPixelShaderPtr ps)
+{
+	m_vs = vs;
+	m_ps = ps;
+}
+
+//-------------------------------------------------------------------------------------
+void CommandList::setVSConstants(int32_t index, const uint8_t* buffer, size_t length)
+{
+	assert(index >= 0 && index < ConstantBuffer::MAX_BUFFER_COUNTS && index != ConstantBuffer::VIEW_CONSTANT_SLOT);
+	m_vsConstants[index].assign(buffer, buffer + length);
+}
+
+//-------------------------------------------------------------------------------------
+void CommandList::setPSConstants(int32_t index, const uint8_t* buffer, size_t length)
+{
+	assert(index >= 0 && index < ConstantBuffer::MAX_BUFFER_COUNTS && index != ConstantBuffer::VIEW_CONSTANT_SLOT);
+	m_psConstants[index].assign(buffer, buffer + length);
+}
+
+//-------------------------------------------------------------------------------------
+void CommandList::drawIndexed(PrimitiveType primitiveType, ConstVertexBufferPtr vertexBuffer, ConstIndexBufferPtr indexBuffer)
+{
+	m_vertexStreams.assign(1, vertexBuffer);
+	_drawIndexed(primitiveType, indexBuffer);
+}
+
+//-------------------------------------------------------------------------------------
+void CommandList::drawIndexed(PrimitiveType primitiveType, const std::vector<VertexBufferPtr>& vertexStreams, ConstIndexBufferPtr indexBuffer)
+{
+	m_vertexStreams.assign(vertexStreams.begin(), vertexStreams.end());
+	_drawIndexed(primitiveType, indexBuffer);
+}
+
+//-------------------------------------------------------------------------------------
+void CommandList::_drawIndexed(PrimitiveType primitiveType, ConstIndexBufferPtr indexBuffer)
+{
+	assert(m_vs != nullptr && m_ps != nullptr);
+
+	if (m_drawCounts == m_draws.size()) {
+		m_draws.push_back(std::make_shared<CommandRenderable>());
+	}
+	std::shared_ptr<CommandRenderable> draw = m_draws[m_drawCounts++];
+
+	draw->build(m_device, primitiveType, m_vertexStreams, indexBuffer, m_transform, m_vs, m_ps);
+	draw->setCullMode(m_cullMode);
+	draw->setShadingRate(m_shadingRate);
+	draw->setBlendState(m_blendState);
+	draw->setDepthStencilState(m_depthStencilState);
+
+	m_vs->preRender(m_transform, draw);
+	m_ps->preRender(draw);
+
+	for (int32_t i = 0; i < ConstantBuffer::MAX_BUFFER_COUNTS; i++) {
+		if (!m_vsConstants[i].empty()) draw->setVSConstantBuffer(i, &(m_vsConstants[i][0]), m_vsConstants[i].size());
+		if (!m_psConstants[i].empty()) draw->setPSConstantBuffer(i, &(m_psConstants[i][0]), m_psConstants[i].size());
+	}
+}
+
+//-------------------------------------------------------------------------------------
+RenderablePtr CommandList::getDraw(size_t index) const
+{
+	assert(index < m_drawCounts);
+	return m_draws[index];
+}
+
+}
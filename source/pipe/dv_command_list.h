@@ -0,0 +1,69 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+//to be remove
+#include "device/dv_constant_buffer.h"
+#include "device/dv_blend_state.h"
+#include "device/dv_depth_stencil_state.h"
+
+namespace davinci
+{
+
+class CommandRenderable;
+
+//Draws recorded without touching RenderQueue, so several threads can each record their own list in parallel.
+//Lists are submitted to the queue on one thread(RenderQueue::submit), draws keep the order of submission
+//between renderables of the same sort key
+class CommandList : noncopyable
+{
+public:
+	//drop recorded draws and reset state, renderables are reused, so the list must have been 
+	//removed from queue(RenderQueue::clearSubmitted)
+	void reset(void);
+
+	//state of following draws
+	void setShaders(ConstVertexShaderPtr vs, ConstPixelShaderPtr ps);
+	void setWorldTransform(const fMatrix4& transform) { m_transform = transform; }
+	void setCullMode(CullMode cullMode) { m_cullMode = cullMode; }
+	void setShadingRate(ShadingRate shadingRate) { m_shadingRate = shadingRate; }
+	void setBlendState(const BlendState& blendState) { m_blendState = blendState; }
+	void setDepthStencilState(const DepthStencilState& depthStencilState) { m_depthStencilState = depthStencilState; }
+	//constants copied into slot of following draws after preRender of shaders, length 0 to unset
+	void setVSConstants(int32_t index, const uint8_t* buffer, size_t length);
+	void setPSConstants(int32_t index, const uint8_t* buffer, size_t length);
+
+	//record a draw with current state, shaders write their constants(preRender) at this time
+	void drawIndexed(PrimitiveType primitiveType, ConstVertexBufferPtr vertexBuffer, ConstIndexBufferPtr indexBuffer);
+	//vertex data split into streams, see Renderable::getVertexStream
+	void drawIndexed(PrimitiveType primitiveType, const std::vector<VertexBufferPtr>& vertexStreams, ConstIndexBufferPtr indexBuffer);
+
+	size_t getDrawCounts(void) const { return m_drawCounts; }
+	RenderablePtr getDraw(size_t index) const;
+
+private:
+	void _drawIndexed(PrimitiveType primitiveType, ConstIndexBufferPtr indexBuffer);
+
+private:
+	const RenderDevice* m_device;
+	ConstVertexShaderPtr m_vs;
+	ConstPixelShaderPtr m_ps;
+	fMatrix4 m_transform;
+	CullMode m_cullMode;
+	ShadingRate m_shadingRate;
+	BlendState m_blendState;
+	DepthStencilState m_depthStencilState;
+	std::vector<uint8_t> m_vsConstants[ConstantBuffer::MAX_BUFFER_COUNTS];
+	std::vector<uint8_t> m_psConstants[ConstantBuffer::MAX_BUFFER_COUNTS];
+	std::vector<ConstVertexBufferPtr> m_vertexStreams;
+
+	//draws are kept after reset, so constant buffers are rewritten in place next frame
+	std::vector<std::shared_ptr<CommandRenderable>> m_draws;
+	size_t m_drawCounts;
+
+public:
+	CommandList(const RenderDevice* device);
+	~CommandList();
+};
+
+}
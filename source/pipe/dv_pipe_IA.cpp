@@ -12,45 +12,187 @@ namespace davinci
 {
 
 //-------------------------------------------------------------------------------------
-void InputAssember::process(const RenderQueue& renderQueue, PrimitiveAfterAssember& output)
+void InputAssember::process(const RenderQueue& renderQueue, bool attributePhase, PrimitiveAfterAssember& output)
 {
-	renderQueue.visitorRenderable([&renderQueue, &output](ConstRenderablePtr renderable) {
-		switch (renderable->getPrimitiveType()) {
-		case PT_POINT_LIST:
-		case PT_LINE_LIST:
-		case PT_TRIANGLE_LIST:
-		{
-			PrimitiveAfterAssember::Node node;
-			size_t vertexSize = renderable->getVertexBuffer()->vertexSize();
-
-			node.transform = renderable->getWorldTransform();
-			node.primitiveType = renderable->getPrimitiveType();
-			node.vertexSize = renderable->getVertexBuffer()->vertexSize();
-			node.vertexCounts = renderable->getIndexBuffer()->counts();
-			node.vertexData = renderQueue.getDevice()->createDeviceBuffer(node.vertexCounts*vertexSize*sizeof(float));
-			node.vs = renderable->getVS();
-			node.ps = renderable->getPS();
-			node.vsConstantBuffer = renderable->getVSConstantBuffer();
-			node.psConstantBuffer = renderable->getPSConstantBuffer();
-			node.vertexElementOffset = renderable->getVertexBuffer()->getVertexDesc().getElementOffset();
-
-			//copy vertex data
-			for (size_t i = 0; i < node.vertexCounts; i++) {
-
-				uint16_t index = renderable->getIndexBuffer()->get(i);
-				//vertex data
-				memcpy(node.vertexData->ptr(i*vertexSize*sizeof(float)), renderable->getVertexBuffer()->ptr(index), vertexSize * sizeof(float));
+	renderQueue.visitorRenderable([&renderQueue, attributePhase, &output](ConstRenderablePtr renderable) {
+		PrimitiveAfterAssember::Node node;
+
+		if (processChunk(renderQueue.getDevice(), renderable, 0, primitiveCounts(renderable), 0, attributePhase, node) && node.vertexCounts > 0) {
+			output.pushNode(node);
+		}
+	});
+}
+
+//-------------------------------------------------------------------------------------
+size_t InputAssember::verticesPerPrimitive(PrimitiveType primitiveType)
+{
+	switch (primitiveType) {
+	case PT_POINT_LIST: return 1;
+	case PT_LINE_LIST: 
+	case PT_LINE_STRIP: return 2;
+	case PT_TRIANGLE_LIST: 
+	case PT_TRIANGLE_STRIP: return 3;
+	default: return 0;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+size_t InputAssember::primitiveCounts(ConstRenderablePtr renderable)
+{
+	size_t vertices = verticesPerPrimitive(renderable->getPrimitiveType());
+	if (vertices == 0) return 0;
+
+	size_t indexCounts = renderable->getIndexBuffer()->counts();
+	if (isStripPrimitive(renderable->getPrimitiveType())) {
+		return indexCounts >= vertices ? indexCounts - vertices + 1 : 0;
+	}
+	return indexCounts / vertices;
+}
+
+//-------------------------------------------------------------------------------------
+//vertex streams read by vertex shader, packed one after another in the assembled vertex
+struct _StreamBinding
+{
+	enum { MAX_STREAM_COUNTS = 8 };
+
+	const VertexBuffer* streams[MAX_STREAM_COUNTS];
+	size_t offset[MAX_STREAM_COUNTS];
+	size_t counts;
+	size_t vertexSize;
+};
+
+//-------------------------------------------------------------------------------------
+//copy vertices of indices[firstIndex, firstIndex+indexCounts), typed by index format.
+//strips start with stripParity, and nextStripParity is taken at index nextFirstIndex(relative to firstIndex)
+template<typename IndexType>
+static bool _fetchVertices(const IndexType* indices, size_t firstIndex, size_t indexCounts, bool strip, 
+	uint32_t stripParity, size_t nextFirstIndex, const _StreamBinding& binding, PrimitiveAfterAssember::Node& node)
+{
+	//all bits set, 0xFFFF for 16-bit indices
+	const IndexType restartIndex = (IndexType)IndexBuffer::RESTART_INDEX32;
+	const size_t vertexSize = binding.vertexSize;
+
+	node.stripStarts.clear();
+	node.stripParity = node.nextStripParity = 0;
+	if (strip) {
+		//strips are copied as they are, a restart index ends the strip and takes no vertex
+		node.stripStarts.push_back(0);
+		node.stripParity = stripParity;
+		node.vertexIndices.clear();
+		const bool keepIndices = !node.attributeStreams.empty();
+
+		//parity of the running strip, a restart index starts an even one
+		uint32_t parity = stripParity;
+		node.vertexCounts = 0;
+		for (size_t i = 0; i < indexCounts; i++) {
+			if (i == nextFirstIndex) node.nextStripParity = parity;
+
+			IndexType index = indices[firstIndex + i];
+			if (index == restartIndex) {
+				node.stripStarts.push_back((uint32_t)node.vertexCounts);
+				parity = 0;
+				continue;
+			}
+			parity ^= 1;
+			if (keepIndices) node.vertexIndices.push_back(index);
+
+			float* vertex = (float*)node.vertexData->ptr(node.vertexCounts*vertexSize*sizeof(float));
+			for (size_t s = 0; s < binding.counts; s++) {
+				memcpy(vertex + binding.offset[s], binding.streams[s]->ptr(index), binding.streams[s]->vertexSize() * sizeof(float));
 			}
+			node.vertexCounts++;
+		}
+		return true;
+	}
 
+	//attribute phase fetches the other streams by the same indices
+	if (!node.attributeStreams.empty()) {
+		node.vertexIndices.assign(indices + firstIndex, indices + firstIndex + node.vertexCounts);
+	}
 
-			output.pushNode(node);
+	//copy vertex data, one stream which is the whole vertex
+	if (binding.counts == 1 && node.attributeStreams.empty()) {
+		const VertexBuffer* stream = binding.streams[0];
+		for (size_t i = 0; i < node.vertexCounts; i++) {
+			IndexType index = indices[firstIndex + i];
+			memcpy(node.vertexData->ptr(i*vertexSize*sizeof(float)), stream->ptr(index), vertexSize * sizeof(float));
 		}
-		break;
+		return true;
+	}
 
-		default:
-			break;
+	for (size_t i = 0; i < node.vertexCounts; i++) {
+		IndexType index = indices[firstIndex + i];
+		float* vertex = (float*)node.vertexData->ptr(i*vertexSize*sizeof(float));
+
+		for (size_t s = 0; s < binding.counts; s++) {
+			memcpy(vertex + binding.offset[s], binding.streams[s]->ptr(index), binding.streams[s]->vertexSize() * sizeof(float));
 		}
-	});
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool InputAssember::processChunk(const RenderDevice* device, ConstRenderablePtr renderable, size_t firstPrimitive, size_t primitiveCounts, 
+	uint32_t stripParity, bool attributePhase, PrimitiveAfterAssember::Node& node)
+{
+	size_t verticesPerPrim = verticesPerPrimitive(renderable->getPrimitiveType());
+	if (verticesPerPrim == 0 || primitiveCounts == 0) return false;
+
+	ConstIndexBufferPtr indexBuffer = renderable->getIndexBuffer();
+	const bool strip = isStripPrimitive(renderable->getPrimitiveType());
+	size_t firstIndex = strip ? firstPrimitive : firstPrimitive * verticesPerPrim;
+	size_t indexCounts = strip ? primitiveCounts + verticesPerPrim - 1 : primitiveCounts * verticesPerPrim;
+
+	//streams with any element read by vertex shader, the ones without position phase elements are fetched later
+	uint32_t positionMask = renderable->getVS()->getInputElementMask(false);
+	uint32_t elementMask = attributePhase ? renderable->getVS()->getInputElementMask(true) : positionMask;
+	_StreamBinding binding;
+	binding.counts = binding.vertexSize = 0;
+
+	node.vertexElementOffset.assign((size_t)VertexElementType::VET_COUNTS, -1);
+	node.attributeStreams.clear();
+	for (size_t i = 0; i < renderable->getVertexStreamCounts(); i++) {
+		const VertexBuffer* stream = renderable->getVertexStream(i).get();
+		const VertexDesc& desc = stream->getVertexDesc();
+		if ((desc.getElementMask() & elementMask) == 0) continue;
+
+		for (size_t j = 0; j < (size_t)VertexElementType::VET_COUNTS; j++) {
+			if (desc.getElementOffset()[j] >= 0) node.vertexElementOffset[j] = (int32_t)binding.vertexSize + desc.getElementOffset()[j];
+		}
+		if (desc.getElementMask() & positionMask) {
+			assert(binding.counts < _StreamBinding::MAX_STREAM_COUNTS);
+			binding.streams[binding.counts] = stream;
+			binding.offset[binding.counts++] = binding.vertexSize;
+		}
+		else {
+			PrimitiveAfterAssember::AttributeStream attribute = { stream, binding.vertexSize };
+			node.attributeStreams.push_back(attribute);
+		}
+		binding.vertexSize += stream->vertexSize();
+	}
+	if (binding.counts == 0) return false;
+
+	node.transform = renderable->getWorldTransform();
+	node.primitiveType = renderable->getPrimitiveType();
+	node.cullMode = renderable->getCullMode();
+	node.shadingRate = renderable->getShadingRate();
+	node.blendState = renderable->getBlendState();
+	node.depthStencilState = renderable->getDepthStencilState();
+	node.vertexSize = binding.vertexSize;
+	node.vertexCounts = indexCounts;
+	node.vertexData = device->reuseDeviceBuffer(node.vertexData, node.vertexCounts*binding.vertexSize*sizeof(float));
+	node.vs = renderable->getVS();
+	node.ps = renderable->getPS();
+	node.vsConstantBuffer = renderable->getVSConstantBuffer();
+	node.psConstantBuffer = renderable->getPSConstantBuffer();
+	node.instanceBuffer = renderable->getInstanceBuffer();
+
+	assert(firstIndex + indexCounts <= indexBuffer->counts());
+
+	if (indexBuffer->getFormat() == IF_UINT32) {
+		return _fetchVertices((const uint32_t*)indexBuffer->rawPtr(), firstIndex, indexCounts, strip, stripParity, primitiveCounts, binding, node);
+	}
+	return _fetchVertices((const uint16_t*)indexBuffer->rawPtr(), firstIndex, indexCounts, strip, stripParity, primitiveCounts, binding, node);
 }
 
 }
@@ -5,6 +5,8 @@
 //to be remove
 #include "device/dv_vertex_desc.h"
 #include "device/dv_constant_buffer.h"
+#include "device/dv_blend_state.h"
+#include "device/dv_depth_stencil_state.h"
 
 namespace davinci
 {
@@ -12,6 +14,13 @@ namespace davinci
 class PrimitiveAfterAssember
 {
 public:
+	//vertex stream read by attribute phase only, offset is in floats of the assembled vertex
+	struct AttributeStream
+	{
+		const VertexBuffer*	stream;
+		size_t				offset;
+	};
+
 	struct Node
 	{
 		fMatrix4					transform;
@@ -20,10 +29,20 @@ public:
 		size_t					vertexCounts;
 		VertexDesc::OffsetData	vertexElementOffset;
 		PrimitiveType			primitiveType;
+		CullMode				cullMode;
+		ShadingRate				shadingRate;
+		BlendState				blendState;
+		DepthStencilState		depthStencilState;
 		ConstVertexShaderPtr	vs;
 		ConstPixelShaderPtr		ps;
 		ConstConstantBufferPtr	vsConstantBuffer;
 		ConstConstantBufferPtr	psConstantBuffer;
+		ConstInstanceBufferPtr	instanceBuffer;	//null if not instanced
+		std::vector<uint32_t>	stripStarts;	//first vertex of each strip, strips only
+		uint32_t				stripParity;	//1 if the first strip continues from an odd primitive of last chunk
+		uint32_t				nextStripParity;	//stripParity of the chunk right after this one, strips only
+		std::vector<AttributeStream>	attributeStreams;	//not fetched by IA, see VertexShader::processAttributeNode
+		std::vector<uint32_t>	vertexIndices;	//index of each vertex in the streams, if attributeStreams isn't empty
 	};
 
 	void pushNode(Node& node) {
@@ -42,7 +61,20 @@ private:
 class InputAssember
 {
 public:
-	static void process(const RenderQueue& renderQueue, PrimitiveAfterAssember& output);
+	//only the vertex streams read by the position phase are fetched. if attributePhase is true, the streams 
+	//read by attribute phase only are kept in node and fetched after culling, for vertices of visible primitives
+	static void process(const RenderQueue& renderQueue, bool attributePhase, PrimitiveAfterAssember& output);
+
+	//get vertex counts of one primitive(0 means not supported), a strip primitive shares all but one vertex with the previous one
+	static size_t verticesPerPrimitive(PrimitiveType primitiveType);
+	//get primitive counts of a renderable, for strips it's one per index except the last ones, restart included
+	static size_t primitiveCounts(ConstRenderablePtr renderable);
+	//assemble primitives [firstPrimitive, firstPrimitive+primitiveCounts) of a renderable, strips are kept as strips.
+	//stripParity is 0 for the first chunk, then nextStripParity of the previous chunk, so chunks of a strip go in order.
+	//a strip chunk of restart indices only is valid with no vertex. the vertex buffer of node will be reused if it's big enough. 
+	//vertex of node is the selected streams one after another, vertexElementOffset is relative to the whole vertex
+	static bool processChunk(const RenderDevice* device, ConstRenderablePtr renderable, size_t firstPrimitive, size_t primitiveCounts, 
+		uint32_t stripParity, bool attributePhase, PrimitiveAfterAssember::Node& node);
 };
 
 
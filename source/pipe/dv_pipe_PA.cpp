@@ -0,0 +1,106 @@
+#include "dv_precompiled.h"
+#include "dv_pipe_PA.h"
+
+#include "device/dv_device_buffer.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+static inline bool _outsideFrustum(const fVector3& p0, const fVector3& p1, const fVector3& p2)
+{
+	return 
+		(p0.x < -1.f && p1.x < -1.f && p2.x < -1.f) || (p0.x > 1.f && p1.x > 1.f && p2.x > 1.f) ||
+		(p0.y < -1.f && p1.y < -1.f && p2.y < -1.f) || (p0.y > 1.f && p1.y > 1.f && p2.y > 1.f) ||
+		(p0.z < 0.f && p1.z < 0.f && p2.z < 0.f) || (p0.z > 1.f && p1.z > 1.f && p2.z > 1.f);
+}
+
+//-------------------------------------------------------------------------------------
+static inline bool _betweenSamples(float minValue, float maxValue)
+{
+	//sample points are at pixel center(n+0.5)
+	return std::ceil(minValue - 0.5f) > std::floor(maxValue - 0.5f);
+}
+
+//-------------------------------------------------------------------------------------
+void PrimitiveAssembler::process(int32_t targetWidth, int32_t targetHeight, PrimitiveAfterVS& input, CullStatistics& statistics)
+{
+	input.visitor([targetWidth, targetHeight, &statistics](PrimitiveAfterVS::Node& node) {
+		processNode(targetWidth, targetHeight, node, statistics);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void PrimitiveAssembler::processNode(int32_t targetWidth, int32_t targetHeight, PrimitiveAfterVS::Node& node, CullStatistics& statistics)
+{
+	node.primitives.clear();
+	if (!isTrianglePrimitive(node.primitiveType)) return;
+
+	node.screenPos.resize(node.vertexCounts);
+
+	//same as viewport transform fMatrix4::makeScale(w/2, h/2, 1) * fMatrix4::makeTrans(w/2, h/2, 0)
+	const float halfWidth = targetWidth / 2.f;
+	const float halfHeight = targetHeight / 2.f;
+	const size_t stride = node.vertexSize * sizeof(float);
+
+	auto setupTriangle = [&node, &statistics, halfWidth, halfHeight, stride](uint32_t i0, uint32_t i1, uint32_t i2) {
+		statistics.inputCounts++;
+
+		const fVector3& p0 = *((const fVector3*)node.vertexData->ptr(i0*stride));
+		const fVector3& p1 = *((const fVector3*)node.vertexData->ptr(i1*stride));
+		const fVector3& p2 = *((const fVector3*)node.vertexData->ptr(i2*stride));
+
+		//frustum cull in clip space, before any other work
+		if (_outsideFrustum(p0, p1, p2)) {
+			statistics.frustum++;
+			return;
+		}
+
+		//to window coordinates
+		fVector3& s0 = node.screenPos[i0];
+		fVector3& s1 = node.screenPos[i1];
+		fVector3& s2 = node.screenPos[i2];
+		s0 = fVector3(p0.x * halfWidth + halfWidth, p0.y * halfHeight + halfHeight, node.invZ[i0]);
+		s1 = fVector3(p1.x * halfWidth + halfWidth, p1.y * halfHeight + halfHeight, node.invZ[i1]);
+		s2 = fVector3(p2.x * halfWidth + halfWidth, p2.y * halfHeight + halfHeight, node.invZ[i2]);
+
+		//signed area(x2), positive means counter-clockwise
+		float area = (s1.x - s0.x) * (s2.y - s0.y) - (s1.y - s0.y) * (s2.x - s0.x);
+		if (area == 0.f) {
+			statistics.zeroArea++;
+			return;
+		}
+
+		bool ccw = area > 0.f;
+		if ((node.cullMode == CM_CCW && ccw) || (node.cullMode == CM_CW && !ccw)) {
+			statistics.backFace++;
+			return;
+		}
+
+		//triangles which bounding box doesn't contain any sample point
+		if (_betweenSamples(MathUtil::min3(s0.x, s1.x, s2.x), MathUtil::max3(s0.x, s1.x, s2.x)) ||
+			_betweenSamples(MathUtil::min3(s0.y, s1.y, s2.y), MathUtil::max3(s0.y, s1.y, s2.y))) {
+			statistics.smallPrimitive++;
+			return;
+		}
+
+		//rasterizer only accept clockwise triangles
+		node.primitives.push_back(i0);
+		node.primitives.push_back(ccw ? i2 : i1);
+		node.primitives.push_back(ccw ? i1 : i2);
+	};
+
+	if (node.primitiveType == PT_TRIANGLE_STRIP) {
+		PrimitiveAfterVS::visitStrips(node, [&setupTriangle](uint32_t i, bool odd) {
+			if (odd) setupTriangle(i + 1, i, i + 2);
+			else setupTriangle(i, i + 1, i + 2);
+		});
+		return;
+	}
+
+	for (uint32_t i = 0; i + 2 < node.vertexCounts; i += 3) {
+		setupTriangle(i, i + 1, i + 2);
+	}
+}
+
+}
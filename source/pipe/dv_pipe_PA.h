@@ -0,0 +1,38 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+//to be remove
+#include "dv_pipe_VS.h"
+
+namespace davinci
+{
+
+//Counters of primitive assembler, per cull reason
+struct CullStatistics
+{
+	size_t inputCounts;		//triangles into primitive assembler
+	size_t frustum;			//all vertices outside the same frustum plane
+	size_t zeroArea;		//degenerate triangles
+	size_t backFace;		//rejected by cull mode
+	size_t smallPrimitive;	//triangles fall between sample points
+
+	void reset(void) {
+		inputCounts = frustum = zeroArea = backFace = smallPrimitive = 0;
+	}
+	size_t culledCounts(void) const {
+		return frustum + zeroArea + backFace + smallPrimitive;
+	}
+
+	CullStatistics() { reset(); }
+};
+
+class PrimitiveAssembler
+{
+public:
+	static void process(int32_t targetWidth, int32_t targetHeight, PrimitiveAfterVS& input, CullStatistics& statistics);
+	//cull the triangles of one node, survived triangles are written into node.primitives 
+	static void processNode(int32_t targetWidth, int32_t targetHeight, PrimitiveAfterVS::Node& node, CullStatistics& statistics);
+};
+
+}
@@ -2,114 +2,308 @@
 #include "dv_pipe_PS.h"
 
 #include "device/dv_render_target.h"
+#include "device/dv_gbuffer.h"
+#include "device/dv_render_target_set.h"
 #include "dv_pipe_VS.h"
 #include "dv_rasterizer.h"
+#include "dv_rasterizer_larrabee.h"
 #include "device/dv_device_buffer.h"
 
 namespace davinci
 {
 //-------------------------------------------------------------------------------------
-void PixelShader::process(const PrimitiveAfterVS& input, RenderTarget& output)
+// Rasterize all primitives of a node, call pixelFunc(x, y, interpolatedVertex) for each covered pixel
+template<typename PixelFunction>
+static void _rasterizeNode(const PrimitiveAfterVS::Node& node, int32_t targetWidth, int32_t targetHeight, PixelFunction pixelFunc)
 {
-
-	int32_t targetWidth = output.getWidth();
-	int32_t targetHeight = output.getHeight();
-
 	fMatrix4 view_trans = 
 		fMatrix4::makeScale(targetWidth / 2.f, targetHeight / 2.f, 1.f) * 
 		fMatrix4::makeTrans(targetWidth / 2.f, targetHeight / 2.f, 0.f);
 
-	input.visitor([view_trans, &output](const PrimitiveAfterVS::Node& node) {
+	switch (node.primitiveType) {
+	case PT_POINT_LIST:
+	{
+		for (size_t i = 0; i < node.vertexCounts; i++) {
+			const float* vertex_data = (const float*)(node.vertexData->ptr(i * node.vertexSize*sizeof(float)));
 
-		switch (node.primitiveType) {
-		case PT_POINT_LIST:
-		{
-			for (size_t i = 0; i < node.vertexCounts; i++) {
-				const float* vertex_data = (const float*)(node.vertexData->ptr(i * node.vertexSize*sizeof(float)));
+			const fVector3* input_pos = (const fVector3*)(vertex_data);
+			fVector3 view_pos = (*input_pos) * view_trans;
 
-				fVector4 color;
-				float depth;
-				node.ps->psFunction(node.psConstantBuffer, vertex_data, color, depth);
+			int16_t x = (int16_t)(view_pos.x + 0.5f);
+			int16_t y = (int16_t)(view_pos.y + 0.5f);
+			pixelFunc(x, y, vertex_data);
+		}
+	}
+	break;
 
-				const fVector3* input_pos = (const fVector3*)(vertex_data);
-				fVector3 view_pos = (*input_pos) * view_trans;
+	case PT_LINE_LIST:
+	case PT_LINE_STRIP:
+	{
+		auto drawLine = [targetWidth, targetHeight, &view_trans, &node, &pixelFunc](size_t i) {
+			const float* vertex_start = (const float*)node.vertexData->ptr(i* node.vertexSize*sizeof(float));
+			const float* vertex_end = (const float*)node.vertexData->ptr((i + 1) * node.vertexSize*sizeof(float));
 
-				int16_t x = (int16_t)(view_pos.x + 0.5f);
-				int16_t y = (int16_t)(view_pos.y + 0.5f);
-				output.setPixel(x, y, color, depth);
-			}
+			fVector3 start = (*(const fVector3*)(vertex_start)) * view_trans;
+			fVector3 end = (*(const fVector3*)(vertex_end)) * view_trans;
+
+			Rasterizer::drawLine(targetWidth, targetHeight, start.xy(), end.xy(), [vertex_start, vertex_end, &node, &pixelFunc](const std::pair<int32_t, int32_t> dot, float percent) {
+
+				std::vector<float> vertex(node.vertexSize);
+
+				for (size_t j = 0; j < node.vertexSize; j++) {
+					vertex[j] = MathUtil::lerp(vertex_start[j], vertex_end[j], percent);
+				}
+
+				pixelFunc(dot.first, dot.second, &(vertex[0]));
+			});
+		};
+
+		if (node.primitiveType == PT_LINE_STRIP) {
+			PrimitiveAfterVS::visitStrips(node, [&drawLine](uint32_t i, bool) { drawLine(i); });
+			break;
 		}
-		break;
+		for (size_t i = 0; i + 1 < node.vertexCounts; i+=2) {
+			drawLine(i);
+		}
+	}
+	break;
 
-		case PT_LINE_LIST:
-		{
-			for (size_t i = 0; i < node.vertexCounts; i+=2) {
-				const float* vertex_start = (const float*)node.vertexData->ptr(i* node.vertexSize*sizeof(float));
-				const float* vertex_end = (const float*)node.vertexData->ptr((i + 1) * node.vertexSize*sizeof(float));
+	case PT_TRIANGLE_LIST:
+	case PT_TRIANGLE_STRIP:
+	{
+		//only the triangles survived from primitive assembler
+		for (size_t i = 0; i + 2 < node.primitives.size(); i += 3) {
+			uint32_t i0 = node.primitives[i], i1 = node.primitives[i + 1], i2 = node.primitives[i + 2];
 
-				fVector3 start = (*(const fVector3*)(vertex_start)) * view_trans;
-				fVector3 end = (*(const fVector3*)(vertex_end)) * view_trans;
+			const float* vertex0 = (const float*)(node.vertexData->ptr(i0 * node.vertexSize * sizeof(float)));
+			const float* vertex1 = (const float*)(node.vertexData->ptr(i1 * node.vertexSize * sizeof(float)));
+			const float* vertex2 = (const float*)(node.vertexData->ptr(i2 * node.vertexSize * sizeof(float)));
 
-				Rasterizer::drawLine(output.getWidth(), output.getHeight(), start.xy(), end.xy(), [vertex_start, vertex_end, &node, &output](const std::pair<int32_t, int32_t> dot, float percent) {
+			Rasterizer::drawTriangleLarrabee(targetWidth, targetHeight, node.screenPos[i0], node.screenPos[i1], node.screenPos[i2],
+				[vertex0, vertex1, vertex2, &node, &pixelFunc](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
 
-					std::vector<float> vertex(node.vertexSize);
+					static std::vector<float> vertex;
+					vertex.resize(node.vertexSize);
 
 					for (size_t j = 0; j < node.vertexSize; j++) {
-						vertex[j] = MathUtil::lerp(vertex_start[j], vertex_end[j], percent);
+						vertex[j] = MathUtil::lerp3(vertex0[j], vertex1[j], vertex2[j], percent);
 					}
 
-					fVector4 color;
-					float depth;
-					node.ps->psFunction(node.psConstantBuffer, &(vertex[0]), color, depth);
+					pixelFunc(dot.first, dot.second, &(vertex[0]));
+			});
+		}
+	}
+	break;
 
-					output.setPixel(dot.first, dot.second, color, depth);
-				});
-			}
+	default:
+		break;
+	}
+}
 
+//-------------------------------------------------------------------------------------
+// Write one color to the covered pixels of a 4x4 block, pixel by pixel through the early test
+template<typename Output>
+static inline void _fillBlock(Output& output, int32_t x0, int32_t y0, uint32_t mask, const float* depth, const fVector4& color)
+{
+	for (int32_t i = 0; i < PixelBlock::PIXEL_COUNTS; i++) {
+		if ((mask & (1u << i)) == 0) continue;
+
+		int32_t x = x0 + (i % PixelBlock::SIZE), y = y0 + (i / PixelBlock::SIZE);
+		if (output.earlyTest(x, y, depth[i])) {
+			output.setPixel(x, y, color, depth[i]);
 		}
-		break;
+	}
+}
+
+//default depth state, render target tests and writes the whole block at once
+static inline void _fillBlock(RenderTarget& output, int32_t x0, int32_t y0, uint32_t mask, const float* depth, const fVector4& color)
+{
+	output.fillBlock(x0, y0, mask, depth, color);
+}
 
-		case PT_TRIANGLE_LIST:
-		{
-			for (size_t i = 0; i < node.vertexCounts; i += 3) {
-				const float* vertex0 = (const float*)(node.vertexData->ptr(i* node.vertexSize * sizeof(float)));
-				const float* vertex1 = (const float*)(node.vertexData->ptr((i + 1) * node.vertexSize * sizeof(float)));
-				const float* vertex2 = (const float*)(node.vertexData->ptr((i + 2) * node.vertexSize * sizeof(float)));
+//-------------------------------------------------------------------------------------
+// Fill visible triangles of node with one color, depth test and write is the only work per pixel.
+// Output is RenderTarget, DepthTestWriter or BlendBlockWriter
+template<typename Output>
+static void _fillConstantNode(const PrimitiveAfterVS::Node& node, const fVector4& color, const RenderTarget& target, Output& output)
+{
+	for (size_t i = 0; i < node.primitives.size(); i += 3) {
+		uint32_t i0 = node.primitives[i], i1 = node.primitives[i + 1], i2 = node.primitives[i + 2];
 
-				fVector3 pos0 = (*(const fVector3*)(vertex0)) * view_trans;
-				fVector3 pos1 = (*(const fVector3*)(vertex1)) * view_trans;
-				fVector3 pos2 = (*(const fVector3*)(vertex2)) * view_trans;
+		//depth is the z of position, same as the value written by pixel shaders
+		const float z0 = ((const float*)(node.vertexData->ptr(i0 * node.vertexSize * sizeof(float))))[2];
+		const float z1 = ((const float*)(node.vertexData->ptr(i1 * node.vertexSize * sizeof(float))))[2];
+		const float z2 = ((const float*)(node.vertexData->ptr(i2 * node.vertexSize * sizeof(float))))[2];
 
-				pos0.z = node.invZ[i];
-				pos1.z = node.invZ[i+1];
-				pos2.z = node.invZ[i+2];
+		//one 4x4 block of the traversal at a time
+		auto fillFunc = [z0, z1, z2, &color, &output](int32_t x0, int32_t y0, uint32_t mask, const fVector3* percents) {
+			float depth[PixelBlock::PIXEL_COUNTS];
+			for (int32_t j = 0; j < PixelBlock::PIXEL_COUNTS; j++) {
+				depth[j] = (mask & (1u << j)) ? MathUtil::lerp3(z0, z1, z2, percents[j]) : 0.f;
+			}
+			_fillBlock(output, x0, y0, mask, depth, color);
+		};
+		Rasterizer::drawTriangleLarrabeeBlockT(target.getWidth(), target.getHeight(), node.screenPos[i0], node.screenPos[i1], node.screenPos[i2], fillFunc);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void BlendBlockWriter::flush(void)
+{
+	if (m_block.mask == 0) return;
 
-				Rasterizer::drawTriangleLarrabee(output.getWidth(), output.getHeight(), pos0, pos1, pos2,
-					[vertex0, vertex1, vertex2, &node, &output](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
+	m_output.blendBlock(m_block, m_blendState, m_depthStencilState);
+	m_block.mask = 0;
+}
 
-						static std::vector<float> vertex;
-						vertex.resize(node.vertexSize);
+//-------------------------------------------------------------------------------------
+void PixelShader::psGBuffer(const ConstantBuffer* constantBuffer, const float* input, GBufferPixel& pixel, float& depth) const
+{
+	//shader without deferred support, use the forward color as an unlit albedo
+	fVector4 color;
+	psFunction(constantBuffer, input, color, depth);
 
-						for (size_t j = 0; j < node.vertexSize; j++) {
-							vertex[j] = MathUtil::lerp3(vertex0[j], vertex1[j], vertex2[j], percent);
-						}
+	pixel.normal = fVector3::ZERO;
+	pixel.albedo = color;
+}
 
-						fVector4 color;
-						float depth;
-						node.ps->psFunction(node.psConstantBuffer, &(vertex[0]), color, depth);
+//-------------------------------------------------------------------------------------
+void PixelShader::psMultiTarget(const ConstantBuffer* constantBuffer, const float* input, fVector4* outputs, float& depth) const
+{
+	//shader without MRT support, the forward color goes to target 0
+	psFunction(constantBuffer, input, outputs[0], depth);
+}
 
-						output.setPixel(dot.first, dot.second, color, depth);
-				});
-			}
+//-------------------------------------------------------------------------------------
+void PixelShader::process(const PrimitiveAfterVS& input, RenderTarget& output)
+{
+	input.visitor([&output](const PrimitiveAfterVS::Node& node) {
+		processNode(node, output);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void PixelShader::processNode(const PrimitiveAfterVS::Node& node, RenderTarget& output)
+{
+	//constant shader, evaluate once per draw
+	fVector4 color;
+	if (isTrianglePrimitive(node.primitiveType) && node.ps->psConstant(node.psConstantBuffer.get(), color)) {
+		if (needsBlendUnit(node)) {
+			BlendBlockWriter writer(output, node.blendState, node.depthStencilState);
+			_fillConstantNode(node, color, output, writer);
 		}
-		break;
+		else if (!node.depthStencilState.isDefault()) {
+			DepthTestWriter writer(output, node.depthStencilState);
+			_fillConstantNode(node, color, output, writer);
+		}
+		else {
+			_fillConstantNode(node, color, output, output);
+		}
+		return;
+	}
 
-	default:
-		break;
+	node.ps->shadeNode(node, output);
+}
+
+//-------------------------------------------------------------------------------------
+// Generic path of PixelShader::shadeNode, output is RenderTarget, DepthTestWriter or BlendBlockWriter
+template<typename Output>
+static void _shadeNode(const PixelShader* ps, const PrimitiveAfterVS::Node& node, const RenderTarget& target, Output& output)
+{
+	const ConstantBuffer* constantBuffer = node.psConstantBuffer.get();
+
+	//variable-rate shading, triangles only
+	if (isTrianglePrimitive(node.primitiveType) && (node.shadingRate != SR_1X1 || target.getShadingRateImage() != nullptr)) {
+		const ShadingRate drawRate = node.shadingRate;
+		std::vector<float> vertex(node.vertexSize);
+
+		for (size_t i = 0; i < node.primitives.size(); i += 3) {
+			uint32_t i0 = node.primitives[i], i1 = node.primitives[i + 1], i2 = node.primitives[i + 2];
+
+			const float* vertex0 = (const float*)(node.vertexData->ptr(i0 * node.vertexSize * sizeof(float)));
+			const float* vertex1 = (const float*)(node.vertexData->ptr(i1 * node.vertexSize * sizeof(float)));
+			const float* vertex2 = (const float*)(node.vertexData->ptr(i2 * node.vertexSize * sizeof(float)));
+
+			CoarsePixelCache cache;
+			auto pixelFunc = [ps, constantBuffer, vertex0, vertex1, vertex2, drawRate, &node, &cache, &vertex, &target, &output](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
+				float pixelDepth = MathUtil::lerp3(vertex0[2], vertex1[2], vertex2[2], percent);
+				if (!output.earlyTest(dot.first, dot.second, pixelDepth)) return;
+
+				ShadingRate rate = target.getShadingRate(dot.first, dot.second, drawRate);
+
+				fVector4 color;
+				if (!cache.find(dot.first, dot.second, rate, color)) {
+					for (size_t j = 0; j < node.vertexSize; j++) {
+						vertex[j] = MathUtil::lerp3(vertex0[j], vertex1[j], vertex2[j], percent);
+					}
+					float depth;
+					ps->psFunction(constantBuffer, &(vertex[0]), color, depth);
+					cache.store(dot.first, dot.second, rate, color);
+				}
+				output.setPixel(dot.first, dot.second, color, pixelDepth);
+			};
+			Rasterizer::drawTriangleLarrabeeT(target.getWidth(), target.getHeight(), node.screenPos[i0], node.screenPos[i1], node.screenPos[i2], pixelFunc);
 		}
+		return;
+	}
+
+	_rasterizeNode(node, target.getWidth(), target.getHeight(), [ps, constantBuffer, &output](int32_t x, int32_t y, const float* vertex) {
+		if (!output.earlyTest(x, y, vertex[2])) return;
+
+		fVector4 color;
+		float depth;
+		ps->psFunction(constantBuffer, vertex, color, depth);
+
+		output.setPixel(x, y, color, depth);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void PixelShader::shadeNode(const PrimitiveAfterVS::Node& node, RenderTarget& output) const
+{
+	if (needsBlendUnit(node)) {
+		BlendBlockWriter writer(output, node.blendState, node.depthStencilState);
+		_shadeNode(this, node, output, writer);
+	}
+	else if (!node.depthStencilState.isDefault()) {
+		DepthTestWriter writer(output, node.depthStencilState);
+		_shadeNode(this, node, output, writer);
+	}
+	else {
+		_shadeNode(this, node, output, output);
+	}
+}
 
+//-------------------------------------------------------------------------------------
+void PixelShader::processGBufferNode(const PrimitiveAfterVS::Node& node, GBuffer& output)
+{
+	const PixelShader* ps = node.ps.get();
+	const ConstantBuffer* constantBuffer = node.psConstantBuffer.get();
+
+	_rasterizeNode(node, output.getWidth(), output.getHeight(), [ps, constantBuffer, &output](int32_t x, int32_t y, const float* vertex) {
+		GBufferPixel pixel;
+		float depth;
+		ps->psGBuffer(constantBuffer, vertex, pixel, depth);
+
+		output.setPixel(x, y, pixel, depth);
 	});
 }
 
+//-------------------------------------------------------------------------------------
+void PixelShader::processMultiTargetNode(const PrimitiveAfterVS::Node& node, RenderTargetSet& output)
+{
+	const PixelShader* ps = node.ps.get();
+	const ConstantBuffer* constantBuffer = node.psConstantBuffer.get();
+
+	_rasterizeNode(node, output.getWidth(), output.getHeight(), [ps, constantBuffer, &output](int32_t x, int32_t y, const float* vertex) {
+		if (!output.earlyTest(x, y, vertex[2])) return;
+
+		fVector4 outputs[RenderTargetSet::MAX_TARGET_COUNTS] = { fVector4::BLACK, fVector4::BLACK, fVector4::BLACK, fVector4::BLACK };
+		float depth;
+		ps->psMultiTarget(constantBuffer, vertex, outputs, depth);
+
+		output.setPixel(x, y, outputs, depth);
+	});
 }
 
+}
@@ -2,19 +2,157 @@
 
 #include "dv_prerequisites.h"
 
+//to be remove
+#include "dv_pipe_VS.h"
+#include "device/dv_render_target.h"
 
 namespace davinci
 {
 
+//Variable-rate shading, colors of coarse pixels already shaded in one triangle.
+//A coarse pixel is aligned in screen space and shaded at its first covered pixel, the color is 
+//broadcast to other covered pixels of the same triangle, depth stays per-pixel
+class CoarsePixelCache
+{
+public:
+	bool find(int32_t x, int32_t y, ShadingRate rate, fVector4& color) const {
+		const Entry& entry = m_entries[_slot(x, y, rate)];
+		if (entry.x != (x >> rate) || entry.y != (y >> rate) || entry.rate != rate) return false;
+
+		color = entry.color;
+		return true;
+	}
+
+	void store(int32_t x, int32_t y, ShadingRate rate, const fVector4& color) {
+		Entry& entry = m_entries[_slot(x, y, rate)];
+		entry.x = x >> rate;
+		entry.y = y >> rate;
+		entry.rate = rate;
+		entry.color = color;
+	}
+
+private:
+	//rasterizer walks 4x4 blocks, which hold at most 2x2 coarse pixels
+	static int32_t _slot(int32_t x, int32_t y, ShadingRate rate) {
+		return (((y >> rate) & 1) << 1) | ((x >> rate) & 1);
+	}
+
+	struct Entry
+	{
+		int32_t x, y;
+		ShadingRate rate;
+		fVector4 color;
+	};
+	Entry m_entries[4];
+
+public:
+	CoarsePixelCache() {
+		for (Entry& entry : m_entries) {
+			entry.x = entry.y = -1;
+			entry.rate = SR_1X1;
+		}
+	}
+};
+
+//Collect shaded pixels into 4x4 blocks and send each block to blend unit of render target as a whole,
+//used by draws with blending or stencil
+class BlendBlockWriter
+{
+public:
+	//early depth/stencil test, a pending pixel at the same position must reach render target first
+	bool earlyTest(int32_t x, int32_t y, float depth) {
+		int32_t x0 = x & ~(PixelBlock::SIZE - 1), y0 = y & ~(PixelBlock::SIZE - 1);
+		int32_t index = (y - y0)*PixelBlock::SIZE + (x - x0);
+
+		if (m_block.mask != 0 && x0 == m_block.x0 && y0 == m_block.y0 && (m_block.mask & (1u << index))) {
+			flush();
+		}
+		return m_output.earlyTest(x, y, depth, m_depthStencilState);
+	}
+
+	void setPixel(int32_t x, int32_t y, const fVector4& color, float depth) {
+		int32_t x0 = x & ~(PixelBlock::SIZE - 1), y0 = y & ~(PixelBlock::SIZE - 1);
+		int32_t index = (y - y0)*PixelBlock::SIZE + (x - x0);
+
+		//next block, or the same pixel again(next triangle), must be blended after current block
+		if (m_block.mask != 0 && (x0 != m_block.x0 || y0 != m_block.y0 || (m_block.mask & (1u << index)))) {
+			flush();
+		}
+		m_block.x0 = x0;
+		m_block.y0 = y0;
+		m_block.mask |= (1u << index);
+		m_block.color[index] = color;
+		m_block.depth[index] = depth;
+	}
+
+	void flush(void);
+
+private:
+	RenderTarget& m_output;
+	const BlendState& m_blendState;
+	const DepthStencilState& m_depthStencilState;
+	PixelBlock m_block;
+
+public:
+	BlendBlockWriter(RenderTarget& output, const BlendState& blendState, const DepthStencilState& depthStencilState)
+		: m_output(output), m_blendState(blendState), m_depthStencilState(depthStencilState) {
+		m_block.mask = 0;
+	}
+	~BlendBlockWriter() { flush(); }
+};
+
+//Opaque draws with non-default depth test(e.g. CF_EQUAL after a Z-prepass), pixels are written one by one
+class DepthTestWriter
+{
+public:
+	bool earlyTest(int32_t x, int32_t y, float depth) const {
+		return m_output.earlyTest(x, y, depth, m_depthStencilState);
+	}
+
+	void setPixel(int32_t x, int32_t y, const fVector4& color, float depth) {
+		m_output.setPixel(x, y, color, depth, m_depthStencilState);
+	}
+
+private:
+	RenderTarget& m_output;
+	const DepthStencilState& m_depthStencilState;
+
+public:
+	DepthTestWriter(RenderTarget& output, const DepthStencilState& depthStencilState)
+		: m_output(output), m_depthStencilState(depthStencilState) {}
+	~DepthTestWriter() {}
+};
+
 class PixelShader
 {
 
 public:
 	virtual void preRender(RenderablePtr renderable) const = 0;
-	virtual void psFunction(ConstConstantBufferPtr constantBuffer, const float* input, fVector4& color, float& depth) const = 0;
+	virtual void psFunction(const ConstantBuffer* constantBuffer, const float* input, fVector4& color, float& depth) const = 0;
+	//geometry pass of deferred shading, output surface attributes instead of lit color
+	virtual void psGBuffer(const ConstantBuffer* constantBuffer, const float* input, GBufferPixel& pixel, float& depth) const;
+	//multiple render targets, outputs[i] is written to target i of RenderTargetSet(at most RenderTargetSet::MAX_TARGET_COUNTS)
+	virtual void psMultiTarget(const ConstantBuffer* constantBuffer, const float* input, fVector4* outputs, float& depth) const;
+
+	//shader whose color doesn't depend on input can return true with the color of the whole draw, 
+	//then PS stage only interpolates depth(z of position) and fills the coverage of triangles without psFunction
+	virtual bool psConstant(const ConstantBuffer* constantBuffer, fVector4& color) const {
+		return false;
+	}
+
+	//rasterize and shade one node into render target, PixelShaderT replaces it with a devirtualised path
+	virtual void shadeNode(const PrimitiveAfterVS::Node& node, RenderTarget& output) const;
 
 public:
 	static void process(const PrimitiveAfterVS& input, RenderTarget& output);
+	static void processNode(const PrimitiveAfterVS::Node& node, RenderTarget& output);
+	static void processGBufferNode(const PrimitiveAfterVS::Node& node, GBuffer& output);
+	static void processMultiTargetNode(const PrimitiveAfterVS::Node& node, RenderTargetSet& output);
+
+	//pixels of node go through blend unit(BlendBlockWriter) instead of RenderTarget::setPixel
+	static bool needsBlendUnit(const PrimitiveAfterVS::Node& node) {
+		return node.blendState.blendEnable || node.depthStencilState.stencilEnable;
+	}
 
 public:
 	PixelShader() {}
@@ -4,6 +4,8 @@
 #include "dv_pipe_IA.h"
 #include "device/dv_render_device.h"
 #include "device/dv_device_buffer.h"
+#include "device/dv_instance_buffer.h"
+#include "device/dv_vertex_buffer.h"
 
 namespace davinci
 {
@@ -11,29 +13,102 @@ namespace davinci
 //-------------------------------------------------------------------------------------
 void VertexShader::process(const RenderDevice* device, const PrimitiveAfterAssember& input, PrimitiveAfterVS& output)
 {
-	input.visitor([device, &input, &output](const PrimitiveAfterAssember::Node& inputNode) {
-		PrimitiveAfterVS::Node outputNode;
-
-		outputNode.vertexSize = inputNode.vs->getOutputVertexDesc().vertexSize();
-		outputNode.vertexCounts = inputNode.vertexCounts;
-		outputNode.vertexData = device->createDeviceBuffer(inputNode.vertexCounts * outputNode.vertexSize*sizeof(float));
-		outputNode.primitiveType = inputNode.primitiveType;
-		outputNode.ps = inputNode.ps;
-		outputNode.psConstantBuffer = inputNode.psConstantBuffer;
-		outputNode.invZ.resize(inputNode.vertexCounts);
-
-		fMatrix4 trans = inputNode.transform;
-
-		//vs shader
-		for (size_t i = 0; i < inputNode.vertexCounts; i++) {
-			const float* in = (const float*)(inputNode.vertexData->ptr(i*inputNode.vertexSize*sizeof(float)));
-			float* out = (float*)(outputNode.vertexData->ptr(i*outputNode.vertexSize*sizeof(float)));
-			float& invZ = outputNode.invZ[i];
-
-			inputNode.vs->vsFunction(inputNode.vsConstantBuffer, in, inputNode.vertexElementOffset, out, invZ);
+	input.visitor([device, &output](const PrimitiveAfterAssember::Node& inputNode) {
+		size_t instanceCounts = inputNode.instanceBuffer ? inputNode.instanceBuffer->counts() : 1;
+
+		for (size_t i = 0; i < instanceCounts; i++) {
+			PrimitiveAfterVS::Node outputNode;
+
+			processNode(device, inputNode, (uint32_t)i, outputNode);
+			output.pushNode(outputNode);
+		}
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void VertexShader::processNode(const RenderDevice* device, const PrimitiveAfterAssember::Node& inputNode, uint32_t instanceID, PrimitiveAfterVS::Node& outputNode)
+{
+	outputNode.vertexSize = inputNode.vs->getOutputVertexDesc().vertexSize();
+	outputNode.vertexCounts = inputNode.vertexCounts;
+	outputNode.vertexData = device->reuseDeviceBuffer(outputNode.vertexData, inputNode.vertexCounts * outputNode.vertexSize*sizeof(float));
+	outputNode.primitiveType = inputNode.primitiveType;
+	outputNode.stripStarts = inputNode.stripStarts;
+	outputNode.stripParity = inputNode.stripParity;
+	outputNode.cullMode = inputNode.cullMode;
+	outputNode.shadingRate = inputNode.shadingRate;
+	outputNode.blendState = inputNode.blendState;
+	outputNode.depthStencilState = inputNode.depthStencilState;
+	outputNode.ps = inputNode.ps;
+	outputNode.psConstantBuffer = inputNode.psConstantBuffer;
+	outputNode.invZ.resize(inputNode.vertexCounts);
+	outputNode.vs = inputNode.vs;
+	outputNode.vsConstantBuffer = inputNode.vsConstantBuffer;
+	if (inputNode.instanceBuffer) {
+		//constants of renderable plus the data of this instance
+		if (outputNode.instanceConstantBuffer == nullptr) {
+			outputNode.instanceConstantBuffer = std::make_shared<ConstantBuffer>(device);
 		}
+		outputNode.instanceConstantBuffer->bindInstance(*inputNode.vsConstantBuffer, inputNode.instanceBuffer->ptr(instanceID), instanceID);
+		outputNode.vsConstantBuffer = outputNode.instanceConstantBuffer;
+	}
+	outputNode.inputData = inputNode.vertexData;
+	outputNode.inputVertexSize = inputNode.vertexSize;
+	outputNode.inputElementOffset = inputNode.vertexElementOffset;
+	outputNode.attributeStreams = inputNode.attributeStreams;
+	outputNode.inputIndices = inputNode.vertexIndices;
+
+	//vs shader(position phase)
+	inputNode.vs->shadePositions(inputNode, outputNode);
+}
+
+//-------------------------------------------------------------------------------------
+void VertexShader::shadePositions(const PrimitiveAfterAssember::Node& input, PrimitiveAfterVS::Node& output) const
+{
+	//binding is resolved once per draw, output has the per-instance view
+	const ConstantBuffer* constantBuffer = output.vsConstantBuffer.get();
+
+	for (size_t i = 0; i < input.vertexCounts; i++) {
+		const float* in = (const float*)(input.vertexData->ptr(i*input.vertexSize*sizeof(float)));
+		float* out = (float*)(output.vertexData->ptr(i*output.vertexSize*sizeof(float)));
+
+		vsPosition(constantBuffer, in, input.vertexElementOffset, out, output.invZ[i]);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void VertexShader::processAttribute(PrimitiveAfterVS& input)
+{
+	input.visitor([](PrimitiveAfterVS::Node& node) {
+		processAttributeNode(node);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void VertexShader::processAttributeNode(PrimitiveAfterVS::Node& node)
+{
+	//culled vertices never fetch the streams of attribute phase
+	if (!node.attributeStreams.empty()) {
+		visitAttributeVertices(node, [&node](size_t i) {
+			float* in = (float*)(node.inputData->ptr(i*node.inputVertexSize*sizeof(float)));
+
+			for (const PrimitiveAfterAssember::AttributeStream& attribute : node.attributeStreams) {
+				memcpy(in + attribute.offset, attribute.stream->ptr(node.inputIndices[i]), attribute.stream->vertexSize() * sizeof(float));
+			}
+		});
+	}
+	node.vs->shadeAttributes(node);
+}
+
+//-------------------------------------------------------------------------------------
+void VertexShader::shadeAttributes(PrimitiveAfterVS::Node& node) const
+{
+	const ConstantBuffer* constantBuffer = node.vsConstantBuffer.get();
+
+	visitAttributeVertices(node, [this, &node, constantBuffer](size_t i) {
+		const float* in = (const float*)(node.inputData->ptr(i*node.inputVertexSize*sizeof(float)));
+		float* out = (float*)(node.vertexData->ptr(i*node.vertexSize*sizeof(float)));
 
-		output.pushNode(outputNode);
+		vsAttribute(constantBuffer, in, node.inputElementOffset, out);
 	});
 }
 
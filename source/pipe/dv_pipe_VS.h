@@ -5,6 +5,7 @@
 //to be remove
 #include "device/dv_constant_buffer.h"
 #include "device/dv_vertex_desc.h"
+#include "dv_pipe_IA.h"
 
 namespace davinci
 {
@@ -18,9 +19,30 @@ public:
 		size_t					vertexSize;
 		size_t					vertexCounts;
 		PrimitiveType			primitiveType;
+		CullMode				cullMode;
+		ShadingRate				shadingRate;
+		BlendState				blendState;
+		DepthStencilState		depthStencilState;
 		ConstPixelShaderPtr		ps;
 		ConstConstantBufferPtr	psConstantBuffer;
 		std::vector<float>		invZ;
+
+		std::vector<uint32_t>	stripStarts;	//see PrimitiveAfterAssember::Node
+		uint32_t				stripParity;
+
+		//input of vertex shader, kept for the attribute phase
+		ConstVertexShaderPtr	vs;
+		ConstConstantBufferPtr	vsConstantBuffer;
+		ConstantBufferPtr		instanceConstantBuffer;	//per-instance view of the constants of renderable, instanced only
+		DeviceBufferPtr			inputData;
+		size_t					inputVertexSize;
+		VertexDesc::OffsetData	inputElementOffset;
+		std::vector<PrimitiveAfterAssember::AttributeStream>	attributeStreams;	//see PrimitiveAfterAssember::Node
+		std::vector<uint32_t>	inputIndices;
+
+		//filled by PrimitiveAssembler
+		std::vector<fVector3>	screenPos;	//window coordinates, z is invZ
+		std::vector<uint32_t>	primitives;	//vertex index of visible triangles, in rasterizer winding
 	};
 
 	void pushNode(Node& node) {
@@ -33,6 +55,36 @@ public:
 		}
 	}
 
+	void visitor(std::function<void(Node&)> visitorFunc) {
+		for (Node& node : m_primitives) {
+			visitorFunc(node);
+		}
+	}
+
+	//call func(firstVertex, odd) for each primitive of a strip node, 
+	//odd triangles of a triangle strip have the first two vertices swapped to keep winding
+	template<typename Function>
+	static void visitStrips(const Node& node, Function func) {
+		const size_t lastVertex = node.primitiveType == PT_TRIANGLE_STRIP ? 2 : 1;
+
+		for (size_t s = 0; s < node.stripStarts.size(); s++) {
+			size_t begin = node.stripStarts[s];
+			size_t end = (s + 1 < node.stripStarts.size()) ? node.stripStarts[s + 1] : node.vertexCounts;
+			size_t parity = (s == 0) ? node.stripParity : 0;
+
+			for (size_t i = begin; i + lastVertex < end; i++) {
+				func((uint32_t)i, ((i - begin + parity) & 1) != 0);
+			}
+		}
+	}
+
+	size_t getNodeCounts(void) const {
+		return m_primitives.size();
+	}
+	const Node& getNode(size_t index) const {
+		return m_primitives[index];
+	}
+
 private:
 	std::vector<Node> m_primitives;
 };
@@ -41,11 +93,64 @@ class VertexShader
 {
 public:
 	virtual void preRender(const fMatrix4& worldTransform, RenderablePtr renderable) const = 0;
-	virtual void vsFunction(ConstConstantBufferPtr constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const = 0;
+	virtual void vsFunction(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const = 0;
 	virtual const VertexDesc& getOutputVertexDesc(void) const = 0;
+	//input elements read by the shader(bit 1<<VertexElementType), position phase only if attributePhase is false.
+	//IA skips the vertex streams without any of them, default is all elements
+	virtual uint32_t getInputElementMask(bool attributePhase) const {
+		return 0xFFFFFFFF;
+	}
+
+	//position phase, run for all vertices before culling, only position and invZ are needed.
+	//default implementation outputs everything by vsFunction, so the attribute phase has nothing to do
+	virtual void vsPosition(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const {
+		vsFunction(constantBuffer, input, inputVertexOffset, output, invZ);
+	}
+	//attribute phase, only run for vertices of visible primitives, output all elements except position
+	virtual void vsAttribute(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output) const {
+	}
+
+	//shade position of all vertices of one node, VertexShaderT replaces it with a devirtualised loop
+	virtual void shadePositions(const PrimitiveAfterAssember::Node& input, PrimitiveAfterVS::Node& output) const;
+	//shade attributes of the vertices given by visitAttributeVertices
+	virtual void shadeAttributes(PrimitiveAfterVS::Node& node) const;
 
 public:
+	//position phase, an instanced node is shaded into one output node per instance
 	static void process(const RenderDevice* device, const PrimitiveAfterAssember& input, PrimitiveAfterVS& output);
+	//shade position of one instance of a node, the vertex buffer of output node will be reused if it's big enough
+	static void processNode(const RenderDevice* device, const PrimitiveAfterAssember::Node& input, uint32_t instanceID, PrimitiveAfterVS::Node& output);
+
+	//attribute phase, must be called after PrimitiveAssembler. 
+	//streams read by attribute phase only are fetched into the input vertices first
+	static void processAttribute(PrimitiveAfterVS& input);
+	static void processAttributeNode(PrimitiveAfterVS::Node& node);
+
+	//call func(vertexIndex) for each vertex needs attribute phase, 
+	//only the vertices of triangles survived from primitive assembler for triangles
+	template<typename Function>
+	static void visitAttributeVertices(const PrimitiveAfterVS::Node& node, Function func) {
+		if (node.primitiveType == PT_TRIANGLE_LIST) {
+			//no vertex is shared in a list
+			for (uint32_t index : node.primitives) {
+				func(index);
+			}
+		}
+		else if (node.primitiveType == PT_TRIANGLE_STRIP) {
+			//vertices are shared by neighbour triangles, shade once
+			std::vector<uint8_t> shaded(node.vertexCounts, 0);
+			for (uint32_t index : node.primitives) {
+				if (shaded[index]) continue;
+				shaded[index] = 1;
+				func(index);
+			}
+		}
+		else {
+			for (size_t i = 0; i < node.vertexCounts; i++) {
+				func(i);
+			}
+		}
+	}
 
 public:
 	VertexShader() {}
@@ -0,0 +1,37 @@
+#include "dv_precompiled.h"
+#include "dv_pipe_deferred.h"
+
+#include "device/dv_gbuffer.h"
+#include "device/dv_render_target.h"
+#include "device/dv_parallel.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+void LightingShader::process(const GBuffer& input, const LightingShader& shader, RenderTarget& output)
+{
+	enum { TILE_SIZE = 64 };
+	assert(input.getWidth() == output.getWidth() && input.getHeight() == output.getHeight());
+
+	//tiles never overlap, so every thread writes its own pixels
+	Parallel::parallelForTiles(input.getWidth(), input.getHeight(), TILE_SIZE, [&input, &shader, &output](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		for (int32_t y = y0; y < y1; y++) {
+			for (int32_t x = x0; x < x1; x++) {
+				if (input.isEmpty(x, y)) continue;
+
+				GBufferPixel pixel;
+				pixel.normal = input.getNormalBuffer().getPixel(x, y);
+				pixel.albedo = input.getAlbedoBuffer().getPixel(x, y);
+				float depth = input.getDepthBuffer().getPixel(x, y);
+
+				fVector4 color;
+				shader.lightingFunction(x, y, pixel, depth, color);
+
+				output.setPixel(x, y, color, depth);
+			}
+		}
+	});
+}
+
+}
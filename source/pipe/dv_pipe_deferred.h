@@ -0,0 +1,24 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+namespace davinci
+{
+
+//Lighting pass of deferred shading
+class LightingShader
+{
+public:
+	//shade one pixel from G-buffer, called exactly once for each pixel covered by geometry
+	virtual void lightingFunction(int32_t x, int32_t y, const GBufferPixel& pixel, float depth, fVector4& color) const = 0;
+
+public:
+	//full-screen pass, G-buffer -> LS -> Render Target Texture, tile-parallel
+	static void process(const GBuffer& input, const LightingShader& shader, RenderTarget& output);
+
+public:
+	LightingShader() {}
+	virtual ~LightingShader() {}
+};
+
+}
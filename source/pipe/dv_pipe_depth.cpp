@@ -0,0 +1,48 @@
+#include "dv_precompiled.h"
+#include "dv_pipe_depth.h"
+
+#include "device/dv_depth_buffer.h"
+#include "device/dv_device_buffer.h"
+#include "dv_rasterizer_larrabee.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+void DepthOnly::processNode(const PrimitiveAfterVS::Node& node, DepthMode mode, DepthBuffer& output)
+{
+	if (!isTrianglePrimitive(node.primitiveType)) return;
+
+	for (size_t i = 0; i < node.primitives.size(); i += 3) {
+		uint32_t i0 = node.primitives[i], i1 = node.primitives[i + 1], i2 = node.primitives[i + 2];
+
+		const float z0 = ((const float*)(node.vertexData->ptr(i0 * node.vertexSize * sizeof(float))))[2];
+		const float z1 = ((const float*)(node.vertexData->ptr(i1 * node.vertexSize * sizeof(float))))[2];
+		const float z2 = ((const float*)(node.vertexData->ptr(i2 * node.vertexSize * sizeof(float))))[2];
+
+		const fVector3& p0 = node.screenPos[i0];
+		const fVector3& p1 = node.screenPos[i1];
+		const fVector3& p2 = node.screenPos[i2];
+
+		if (mode == DM_PLANE) {
+			//z = z0 + dzdx*(x-x0) + dzdy*(y-y0), window z is linear in screen space
+			const float area = (p1.x - p0.x)*(p2.y - p0.y) - (p2.x - p0.x)*(p1.y - p0.y);
+			const float dzdx = ((z1 - z0)*(p2.y - p0.y) - (z2 - z0)*(p1.y - p0.y)) / area;
+			const float dzdy = ((z2 - z0)*(p1.x - p0.x) - (z1 - z0)*(p2.x - p0.x)) / area;
+			const float zc = z0 - dzdx*p0.x - dzdy*p0.y;
+
+			auto depthFunc = [dzdx, dzdy, zc, &output](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
+				output.testAndSet(dot.first, dot.second, zc + dzdx*(dot.first + 0.5f) + dzdy*(dot.second + 0.5f), CF_LESS_EQUAL);
+			};
+			Rasterizer::drawTriangleLarrabeeT(output.getWidth(), output.getHeight(), p0, p1, p2, depthFunc);
+		}
+		else {
+			auto depthFunc = [z0, z1, z2, &output](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
+				output.testAndSet(dot.first, dot.second, MathUtil::lerp3(z0, z1, z2, percent), CF_LESS_EQUAL);
+			};
+			Rasterizer::drawTriangleLarrabeeT(output.getWidth(), output.getHeight(), p0, p1, p2, depthFunc);
+		}
+	}
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+//to be remove
+#include "dv_pipe_VS.h"
+
+namespace davinci
+{
+
+//Depth-only rasterization, no pixel shader and no color target
+class DepthOnly
+{
+public:
+	enum DepthMode
+	{
+		//z from plane equation of triangle in window coordinates, for shadow maps
+		DM_PLANE,
+		//z interpolated the same way as pixel shaders do, so a following pass can use CF_EQUAL
+		DM_INTERPOLATED,
+	};
+
+	//rasterize visible triangles of node, only z of position is used
+	static void processNode(const PrimitiveAfterVS::Node& node, DepthMode mode, DepthBuffer& output);
+};
+
+}
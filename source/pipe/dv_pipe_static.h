@@ -0,0 +1,168 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+#include "dv_pipe_VS.h"
+#include "dv_pipe_PS.h"
+#include "dv_rasterizer_larrabee.h"
+#include "device/dv_device_buffer.h"
+#include "device/dv_render_target.h"
+
+/*
+	Compile-time specialised shaders(opt-in)
+
+	A shader derived from VertexShaderT/PixelShaderT is still a normal VertexShader/PixelShader, but 
+	the pipeline enters it once per node, and its vsPosition/vsAttribute/psFunction are called by 
+	qualified name inside the vertex, raster and interpolation loops, so they can be inlined.
+
+	class MyPixelShader : public PixelShaderT<MyPixelShader, PSIN> { ... psFunction ... };
+
+	Not included by davinci.h, since it pulls in the rasterizer templates, include "pipe/dv_pipe_static.h" to use it.
+*/
+
+namespace davinci
+{
+
+template<typename Derived>
+class VertexShaderT : public VertexShader
+{
+public:
+	virtual void shadePositions(const PrimitiveAfterAssember::Node& input, PrimitiveAfterVS::Node& output) const {
+		const Derived* shader = static_cast<const Derived*>(this);
+		const ConstantBuffer* constantBuffer = output.vsConstantBuffer.get();
+
+		for (size_t i = 0; i < input.vertexCounts; i++) {
+			const float* in = (const float*)(input.vertexData->ptr(i*input.vertexSize*sizeof(float)));
+			float* out = (float*)(output.vertexData->ptr(i*output.vertexSize*sizeof(float)));
+
+			shader->Derived::vsPosition(constantBuffer, in, input.vertexElementOffset, out, output.invZ[i]);
+		}
+	}
+
+	virtual void shadeAttributes(PrimitiveAfterVS::Node& node) const {
+		const Derived* shader = static_cast<const Derived*>(this);
+		const ConstantBuffer* constantBuffer = node.vsConstantBuffer.get();
+
+		visitAttributeVertices(node, [shader, &node, constantBuffer](size_t i) {
+			const float* in = (const float*)(node.inputData->ptr(i*node.inputVertexSize*sizeof(float)));
+			float* out = (float*)(node.vertexData->ptr(i*node.vertexSize*sizeof(float)));
+
+			shader->Derived::vsAttribute(constantBuffer, in, node.inputElementOffset, out);
+		});
+	}
+
+public:
+	VertexShaderT() {}
+	virtual ~VertexShaderT() {}
+};
+
+//PSIN is the vertex layout output by vertex shader, floats only
+template<typename Derived, typename PSIN>
+class PixelShaderT : public PixelShader
+{
+public:
+	virtual void shadeNode(const PrimitiveAfterVS::Node& node, RenderTarget& output) const {
+		//points and lines are rare, use the generic path
+		if (!isTrianglePrimitive(node.primitiveType)) {
+			PixelShader::shadeNode(node, output);
+			return;
+		}
+		assert(node.vertexSize * sizeof(float) == sizeof(PSIN));
+
+		if (PixelShader::needsBlendUnit(node)) {
+			BlendBlockWriter writer(output, node.blendState, node.depthStencilState);
+			_shadeTriangles(node, output, writer);
+		}
+		else if (!node.depthStencilState.isDefault()) {
+			DepthTestWriter writer(output, node.depthStencilState);
+			_shadeTriangles(node, output, writer);
+		}
+		else {
+			_shadeTriangles(node, output, output);
+		}
+	}
+
+private:
+	//output is RenderTarget, DepthTestWriter or BlendBlockWriter
+	template<typename Output>
+	void _shadeTriangles(const PrimitiveAfterVS::Node& node, const RenderTarget& target, Output& output) const {
+		enum { FLOAT_COUNTS = sizeof(PSIN) / sizeof(float) };
+		const Derived* shader = static_cast<const Derived*>(this);
+		const ConstantBuffer* constantBuffer = node.psConstantBuffer.get();
+
+		if (node.shadingRate != SR_1X1 || target.getShadingRateImage() != nullptr) {
+			_shadeTrianglesCoarse(node, target, output);
+			return;
+		}
+
+		for (size_t i = 0; i < node.primitives.size(); i += 3) {
+			uint32_t i0 = node.primitives[i], i1 = node.primitives[i + 1], i2 = node.primitives[i + 2];
+
+			const float* vertex0 = (const float*)(node.vertexData->ptr(i0 * sizeof(PSIN)));
+			const float* vertex1 = (const float*)(node.vertexData->ptr(i1 * sizeof(PSIN)));
+			const float* vertex2 = (const float*)(node.vertexData->ptr(i2 * sizeof(PSIN)));
+
+			auto pixelFunc = [shader, constantBuffer, vertex0, vertex1, vertex2, &output](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
+				//early depth/stencil test, z of position is interpolated first
+				if (!output.earlyTest(dot.first, dot.second, MathUtil::lerp3(vertex0[2], vertex1[2], vertex2[2], percent))) return;
+
+				float vertex[FLOAT_COUNTS];
+				for (size_t j = 0; j < FLOAT_COUNTS; j++) {
+					vertex[j] = MathUtil::lerp3(vertex0[j], vertex1[j], vertex2[j], percent);
+				}
+
+				fVector4 color;
+				float depth;
+				shader->Derived::psFunction(constantBuffer, vertex, color, depth);
+
+				output.setPixel(dot.first, dot.second, color, depth);
+			};
+			Rasterizer::drawTriangleLarrabeeT(target.getWidth(), target.getHeight(), node.screenPos[i0], node.screenPos[i1], node.screenPos[i2], pixelFunc);
+		}
+	}
+
+	//variable-rate shading, see CoarsePixelCache
+	template<typename Output>
+	void _shadeTrianglesCoarse(const PrimitiveAfterVS::Node& node, const RenderTarget& target, Output& output) const {
+		enum { FLOAT_COUNTS = sizeof(PSIN) / sizeof(float) };
+		const Derived* shader = static_cast<const Derived*>(this);
+		const ConstantBuffer* constantBuffer = node.psConstantBuffer.get();
+		const ShadingRate drawRate = node.shadingRate;
+
+		for (size_t i = 0; i < node.primitives.size(); i += 3) {
+			uint32_t i0 = node.primitives[i], i1 = node.primitives[i + 1], i2 = node.primitives[i + 2];
+
+			const float* vertex0 = (const float*)(node.vertexData->ptr(i0 * sizeof(PSIN)));
+			const float* vertex1 = (const float*)(node.vertexData->ptr(i1 * sizeof(PSIN)));
+			const float* vertex2 = (const float*)(node.vertexData->ptr(i2 * sizeof(PSIN)));
+
+			CoarsePixelCache cache;
+			auto pixelFunc = [shader, constantBuffer, vertex0, vertex1, vertex2, drawRate, &cache, &target, &output](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
+				float pixelDepth = MathUtil::lerp3(vertex0[2], vertex1[2], vertex2[2], percent);
+				if (!output.earlyTest(dot.first, dot.second, pixelDepth)) return;
+
+				ShadingRate rate = target.getShadingRate(dot.first, dot.second, drawRate);
+
+				fVector4 color;
+				if (!cache.find(dot.first, dot.second, rate, color)) {
+					float vertex[FLOAT_COUNTS];
+					for (size_t j = 0; j < FLOAT_COUNTS; j++) {
+						vertex[j] = MathUtil::lerp3(vertex0[j], vertex1[j], vertex2[j], percent);
+					}
+					float depth;
+					shader->Derived::psFunction(constantBuffer, vertex, color, depth);
+					cache.store(dot.first, dot.second, rate, color);
+				}
+				//depth is the z of position, per-pixel
+				output.setPixel(dot.first, dot.second, color, pixelDepth);
+			};
+			Rasterizer::drawTriangleLarrabeeT(target.getWidth(), target.getHeight(), node.screenPos[i0], node.screenPos[i1], node.screenPos[i2], pixelFunc);
+		}
+	}
+
+public:
+	PixelShaderT() {}
+	virtual ~PixelShaderT() {}
+};
+
+}
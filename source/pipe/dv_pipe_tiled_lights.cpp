@@ -0,0 +1,151 @@
+#include "dv_precompiled.h"
+#include "dv_pipe_tiled_lights.h"
+
+#include "device/dv_parallel.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+float Light::getAttenuation(const fVector3& worldPos, fVector3& lightDir) const
+{
+	lightDir = position - worldPos;
+	float distance = lightDir.length();
+	if (distance >= range) return 0.f;
+
+	lightDir = lightDir / distance;
+
+	//smooth falloff to zero at range
+	float falloff = 1.f - distance / range;
+	falloff *= falloff;
+
+	if (type == LT_SPOT) {
+		float cosAngle = -lightDir.dotProduct(direction);
+		if (cosAngle <= cosOuterCone) return 0.f;
+
+		falloff *= MathUtil::saturate((cosAngle - cosOuterCone) / (cosInnerCone - cosOuterCone));
+	}
+	return falloff;
+}
+
+//-------------------------------------------------------------------------------------
+fVector4 Light::getBoundingSphere(void) const
+{
+	if (type == LT_POINT) {
+		return fVector4(position, range);
+	}
+
+	//bounding sphere of cone
+	if (cosOuterCone >= 0.70710678f) {
+		//narrow cone, circumsphere of the cap
+		float radius = range / (2.f * cosOuterCone);
+		return fVector4(position + direction * radius, radius);
+	}
+	else {
+		float sinOuterCone = MathUtil::sqrt(1.f - cosOuterCone*cosOuterCone);
+		return fVector4(position + direction * (cosOuterCone * range), sinOuterCone * range);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+LightGrid::LightGrid()
+	: m_width(0)
+	, m_height(0)
+	, m_halfWidth(0.f)
+	, m_halfHeight(0.f)
+	, m_widthInTiles(0)
+{
+}
+
+//-------------------------------------------------------------------------------------
+void LightGrid::build(const PixelBuffer<float>& depthBuffer, const fMatrix4& matViewProj, const std::vector<Light>& lights)
+{
+	m_width = depthBuffer.getWidth();
+	m_height = depthBuffer.getHeight();
+	m_halfWidth = (float)m_width * 0.5f;
+	m_halfHeight = (float)m_height * 0.5f;
+	m_widthInTiles = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+	m_matInvViewProj = matViewProj.inverse();
+
+	m_lights = lights;
+	m_lightSpheres.resize(lights.size());
+	for (size_t i = 0; i < lights.size(); i++) {
+		m_lightSpheres[i] = lights[i].getBoundingSphere();
+	}
+
+	int32_t heightInTiles = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+	m_tileLights.resize((size_t)(m_widthInTiles*heightInTiles));
+
+	//every tile writes its own list
+	Parallel::parallelForTiles(m_width, m_height, TILE_SIZE, [this, &depthBuffer](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		std::vector<uint32_t>& tileLights = m_tileLights[(size_t)((y0 / TILE_SIZE)*m_widthInTiles + x0 / TILE_SIZE)];
+		_cullTile(depthBuffer, x0, y0, x1, y1, tileLights);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void LightGrid::_cullTile(const PixelBuffer<float>& depthBuffer, int32_t x0, int32_t y0, int32_t x1, int32_t y1, std::vector<uint32_t>& tileLights) const
+{
+	tileLights.clear();
+
+	//depth bounds of tile
+	const float emptyDepth = std::numeric_limits<float>::max();
+	float minDepth = emptyDepth, maxDepth = -emptyDepth;
+	for (int32_t y = y0; y < y1; y++) {
+		for (int32_t x = x0; x < x1; x++) {
+			float depth = depthBuffer.getPixel(x, y);
+			if (depth == emptyDepth) continue;
+
+			minDepth = MathUtil::min2(minDepth, depth);
+			maxDepth = MathUtil::max2(maxDepth, depth);
+		}
+	}
+	if (minDepth > maxDepth) return;
+
+	//tile frustum corners in world space, screen -> NDC is the inverse of primitive assembler
+	const float left = (float)x0 / m_halfWidth - 1.f, right = (float)x1 / m_halfWidth - 1.f;
+	const float bottom = (float)y0 / m_halfHeight - 1.f, top = (float)y1 / m_halfHeight - 1.f;
+
+	//side planes from near and far clip, so they never degenerate with flat depth bounds
+	fVector3 corners[8];
+	for (int32_t i = 0; i < 2; i++) {
+		corners[i * 4 + 0] = fVector3(left, bottom, (float)i) * m_matInvViewProj;
+		corners[i * 4 + 1] = fVector3(right, bottom, (float)i) * m_matInvViewProj;
+		corners[i * 4 + 2] = fVector3(right, top, (float)i) * m_matInvViewProj;
+		corners[i * 4 + 3] = fVector3(left, top, (float)i) * m_matInvViewProj;
+	}
+	const fVector3 inside = fVector3((left + right)*0.5f, (bottom + top)*0.5f, 0.5f) * m_matInvViewProj;
+
+	//6 planes as (normal, d), normal points inside
+	fVector4 planes[6];
+	const int32_t sideCorners[4][3] = { { 0, 3, 7 }, { 1, 5, 6 }, { 0, 4, 5 }, { 3, 2, 6 } };
+	for (int32_t i = 0; i < 4; i++) {
+		const fVector3& p0 = corners[sideCorners[i][0]];
+		fVector3 normal = (corners[sideCorners[i][1]] - p0).crossProduct(corners[sideCorners[i][2]] - p0).normalise();
+		if (normal.dotProduct(inside - p0) < 0.f) normal = -normal;
+
+		planes[i] = fVector4(normal, -normal.dotProduct(p0));
+	}
+
+	//planes of constant NDC z are perpendicular to view direction
+	const fVector3 origin = fVector3::ZERO * m_matInvViewProj;
+	const fVector3 forward = (fVector3(0.f, 0.f, 1.f) * m_matInvViewProj - origin).normalise();
+	const fVector3 nearPoint = fVector3(0.f, 0.f, minDepth) * m_matInvViewProj;
+	const fVector3 farPoint = fVector3(0.f, 0.f, maxDepth) * m_matInvViewProj;
+	planes[4] = fVector4(forward, -forward.dotProduct(nearPoint));
+	planes[5] = fVector4(-forward, forward.dotProduct(farPoint));
+
+	//sphere-frustum test, conservative near frustum corners
+	for (uint32_t i = 0; i < (uint32_t)m_lightSpheres.size(); i++) {
+		const fVector4& sphere = m_lightSpheres[i];
+
+		bool sphereInside = true;
+		for (int32_t j = 0; j < 6 && sphereInside; j++) {
+			const fVector4& plane = planes[j];
+			sphereInside = (plane.x*sphere.x + plane.y*sphere.y + plane.z*sphere.z + plane.w) >= -sphere.w;
+		}
+		if (sphereInside) tileLights.push_back(i);
+	}
+}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+//to be remove
+#include "device/dv_pixel_buffer.h"
+
+namespace davinci
+{
+
+//Local light of tiled lighting
+struct Light
+{
+	enum Type
+	{
+		LT_POINT,
+		LT_SPOT,
+	};
+
+	Type type;
+	fVector3 position;
+	fVector3 color;
+	float range;			//no light beyond range
+	fVector3 direction;		//spot light only, normalised
+	float cosInnerCone;		//spot light only, full intensity inside
+	float cosOuterCone;		//spot light only, no light outside
+
+	//return intensity at worldPos(0 if out of range or cone), lightDir is normalised and point to the light
+	float getAttenuation(const fVector3& worldPos, fVector3& lightDir) const;
+	//conservative bounding sphere of lit volume, returned as (center, radius)
+	fVector4 getBoundingSphere(void) const;
+};
+
+//Per-tile light lists of screen, built from depth buffer before shading(Z-prepass or G-buffer).
+//Pixel shaders loop over lights of their own tile instead of all lights.
+class LightGrid
+{
+public:
+	enum { TILE_SIZE = 64 };
+
+	//compute depth bounds of every tile and cull lights against tile frustums, tile-parallel.
+	//empty pixels in depth buffer are max float, tiles without geometry get no lights
+	void build(const PixelBuffer<float>& depthBuffer, const fMatrix4& matViewProj, const std::vector<Light>& lights);
+
+	//indices(to getLight) of lights touching the tile which covers pixel
+	const std::vector<uint32_t>& getTileLights(int32_t x, int32_t y) const {
+		return m_tileLights[(size_t)((y / TILE_SIZE)*m_widthInTiles + x / TILE_SIZE)];
+	}
+	//the same for a position in NDC(output of vertex shader)
+	const std::vector<uint32_t>& getTileLights(const fVector3& posNDC) const {
+		int32_t x = MathUtil::saturate((int32_t)((posNDC.x + 1.f)*m_halfWidth), 0, m_width - 1);
+		int32_t y = MathUtil::saturate((int32_t)((posNDC.y + 1.f)*m_halfHeight), 0, m_height - 1);
+		return getTileLights(x, y);
+	}
+
+	const Light& getLight(uint32_t index) const { return m_lights[index]; }
+
+	//reconstruct world position from NDC
+	fVector3 getWorldPosition(const fVector3& posNDC) const {
+		return posNDC * m_matInvViewProj;
+	}
+
+private:
+	void _cullTile(const PixelBuffer<float>& depthBuffer, int32_t x0, int32_t y0, int32_t x1, int32_t y1, std::vector<uint32_t>& tileLights) const;
+
+private:
+	int32_t m_width;
+	int32_t m_height;
+	float m_halfWidth;
+	float m_halfHeight;
+	int32_t m_widthInTiles;
+	fMatrix4 m_matInvViewProj;
+	std::vector<Light> m_lights;
+	std::vector<fVector4> m_lightSpheres;
+	std::vector<std::vector<uint32_t>> m_tileLights;
+
+public:
+	LightGrid();
+	~LightGrid() {}
+};
+
+}
@@ -0,0 +1,75 @@
+#include "dv_precompiled.h"
+#include "dv_pipe_visibility.h"
+
+#include "device/dv_visibility_buffer.h"
+#include "device/dv_render_target.h"
+#include "device/dv_device_buffer.h"
+#include "device/dv_parallel.h"
+#include "dv_pipe_PS.h"
+#include "dv_rasterizer.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+void VisibilityShading::processNode(uint32_t drawID, const PrimitiveAfterVS::Node& node, VisibilityBuffer& output)
+{
+	if (!isTrianglePrimitive(node.primitiveType)) return;
+	assert(node.primitives.size() / 3 < VisibilityBuffer::MAX_TRIANGLE_COUNTS);
+
+	for (size_t i = 0; i < node.primitives.size(); i += 3) {
+		uint32_t i0 = node.primitives[i], i1 = node.primitives[i + 1], i2 = node.primitives[i + 2];
+
+		//depth is the z of position, same as the value written by pixel shaders
+		const float z0 = ((const float*)(node.vertexData->ptr(i0 * node.vertexSize * sizeof(float))))[2];
+		const float z1 = ((const float*)(node.vertexData->ptr(i1 * node.vertexSize * sizeof(float))))[2];
+		const float z2 = ((const float*)(node.vertexData->ptr(i2 * node.vertexSize * sizeof(float))))[2];
+		const uint32_t id = VisibilityBuffer::makeID(drawID, (uint32_t)(i / 3));
+
+		Rasterizer::drawTriangleLarrabee(output.getWidth(), output.getHeight(), node.screenPos[i0], node.screenPos[i1], node.screenPos[i2],
+			[z0, z1, z2, id, &output](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
+				output.setPixel(dot.first, dot.second, id, MathUtil::lerp3(z0, z1, z2, percent));
+		});
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void VisibilityShading::resolve(const PrimitiveAfterVS& input, size_t firstNode, const VisibilityBuffer& visibility, RenderTarget& output)
+{
+	enum { TILE_SIZE = 64 };
+	assert(visibility.getWidth() == output.getWidth() && visibility.getHeight() == output.getHeight());
+
+	Parallel::parallelForTiles(visibility.getWidth(), visibility.getHeight(), TILE_SIZE, [&input, firstNode, &visibility, &output](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		std::vector<float> vertex;
+
+		for (int32_t y = y0; y < y1; y++) {
+			for (int32_t x = x0; x < x1; x++) {
+				uint32_t id = visibility.getIDBuffer().getPixel(x, y);
+				if (id == VisibilityBuffer::INVALID_ID) continue;
+
+				const PrimitiveAfterVS::Node& node = input.getNode(firstNode + VisibilityBuffer::getDrawID(id));
+				size_t triangle = VisibilityBuffer::getTriangleID(id) * 3;
+				uint32_t i0 = node.primitives[triangle], i1 = node.primitives[triangle + 1], i2 = node.primitives[triangle + 2];
+
+				const float* vertex0 = (const float*)(node.vertexData->ptr(i0 * node.vertexSize * sizeof(float)));
+				const float* vertex1 = (const float*)(node.vertexData->ptr(i1 * node.vertexSize * sizeof(float)));
+				const float* vertex2 = (const float*)(node.vertexData->ptr(i2 * node.vertexSize * sizeof(float)));
+
+				fVector3 percent = Rasterizer::barycentric(node.screenPos[i0], node.screenPos[i1], node.screenPos[i2], x, y);
+
+				vertex.resize(node.vertexSize);
+				for (size_t j = 0; j < node.vertexSize; j++) {
+					vertex[j] = MathUtil::lerp3(vertex0[j], vertex1[j], vertex2[j], percent);
+				}
+
+				fVector4 color;
+				float depth;
+				node.ps->psFunction(node.psConstantBuffer.get(), &(vertex[0]), color, depth);
+
+				output.setPixel(x, y, color, visibility.getDepthBuffer().getPixel(x, y));
+			}
+		}
+	});
+}
+
+}
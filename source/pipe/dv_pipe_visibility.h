@@ -0,0 +1,28 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+//to be remove
+#include "dv_pipe_VS.h"
+
+namespace davinci
+{
+
+//Visibility buffer rendering
+/*
+	raster pass : PrimitiveAfterVS -> Rasterizer -> VisibilityBuffer(draw/triangle id, depth)
+	resolve pass: VisibilityBuffer + PrimitiveAfterVS -> PS -> Render Target Texture
+*/
+class VisibilityShading
+{
+public:
+	//raster pass of one node, only visible triangles of triangle list are written, varyings and ps are skipped
+	static void processNode(uint32_t drawID, const PrimitiveAfterVS::Node& node, VisibilityBuffer& output);
+
+	//rebuild the vertex of each visible pixel from the triangle and shade it once, tile-parallel.
+	//input must be the PrimitiveAfterVS used by raster pass, draw id is the index of node minus firstNode.
+	//pixels are depth tested with output, so the nodes of one frame can be resolved in several batches
+	static void resolve(const PrimitiveAfterVS& input, size_t firstNode, const VisibilityBuffer& visibility, RenderTarget& output);
+};
+
+}
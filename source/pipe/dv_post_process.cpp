@@ -0,0 +1,251 @@
+#include "dv_precompiled.h"
+#include "dv_post_process.h"
+
+#include "device/dv_parallel.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+static inline float _toSRGB(float linear)
+{
+	return (linear <= 0.0031308f) ? linear*12.92f : 1.055f*powf(linear, 1.f / 2.4f) - 0.055f;
+}
+
+//-------------------------------------------------------------------------------------
+static inline float _luma(const fVector4& color)
+{
+	return color.x*0.299f + color.y*0.587f + color.z*0.114f;
+}
+
+//-------------------------------------------------------------------------------------
+// Pixel of buffer with coordinates clamped to edge
+template<typename T>
+static inline const T& _fetch(const PixelBuffer<T>& buffer, int32_t x, int32_t y)
+{
+	x = MathUtil::saturate(x, 0, buffer.getWidth() - 1);
+	y = MathUtil::saturate(y, 0, buffer.getHeight() - 1);
+	return buffer.ptr()[y*buffer.getWidth() + x];
+}
+
+//-------------------------------------------------------------------------------------
+// Bilinear sample at (x, y) in pixels, center of pixel(i, j) is (i + 0.5, j + 0.5)
+static inline fVector4 _sampleBilinear(const PixelBuffer<fVector4>& buffer, float x, float y)
+{
+	x -= 0.5f;
+	y -= 0.5f;
+	float fx = floorf(x), fy = floorf(y);
+	int32_t x0 = (int32_t)fx, y0 = (int32_t)fy;
+	float u = x - fx, v = y - fy;
+
+	fVector4 top = _fetch(buffer, x0, y0)*(1.f - u) + _fetch(buffer, x0 + 1, y0)*u;
+	fVector4 bottom = _fetch(buffer, x0, y0 + 1)*(1.f - u) + _fetch(buffer, x0 + 1, y0 + 1)*u;
+	return top*(1.f - v) + bottom*v;
+}
+
+//-------------------------------------------------------------------------------------
+void PostProcess::toneMap(const PixelBuffer<fVector4>& input, float exposure, ToneMapOperator op, bool sRGB, PixelBuffer<fVector4>& output)
+{
+	assert(input.getWidth() == output.getWidth() && input.getHeight() == output.getHeight());
+	const int32_t width = input.getWidth();
+
+	Parallel::parallelForTiles(width, input.getHeight(), TILE_SIZE, [&input, &output, width, exposure, op, sRGB](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		for (int32_t y = y0; y < y1; y++) {
+			//operator is chosen per row, the loops over rgb floats are left to the compiler to vectorise
+			const float* src = (const float*)(input.ptr() + y*width + x0);
+			float* dest = (float*)(output.ptr() + y*width + x0);
+			const int32_t counts = (x1 - x0) * 4;
+
+			switch (op) {
+			case TM_CLAMP:
+				for (int32_t i = 0; i < counts; i++) dest[i] = (i % 4 == 3) ? src[i] : MathUtil::saturate(src[i] * exposure);
+				break;
+			case TM_REINHARD:
+				for (int32_t i = 0; i < counts; i++) {
+					float c = MathUtil::max2(src[i] * exposure, 0.f);
+					dest[i] = (i % 4 == 3) ? src[i] : c / (1.f + c);
+				}
+				break;
+			case TM_ACES:
+				for (int32_t i = 0; i < counts; i++) {
+					float c = MathUtil::max2(src[i] * exposure, 0.f);
+					dest[i] = (i % 4 == 3) ? src[i] : MathUtil::saturate((c*(2.51f*c + 0.03f)) / (c*(2.43f*c + 0.59f) + 0.14f));
+				}
+				break;
+			}
+
+			if (sRGB) {
+				for (int32_t i = 0; i < counts; i++) {
+					if (i % 4 != 3) dest[i] = _toSRGB(dest[i]);
+				}
+			}
+		}
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void PostProcess::fxaa(const PixelBuffer<fVector4>& input, PixelBuffer<fVector4>& output)
+{
+	assert(&input != &output);
+	assert(input.getWidth() == output.getWidth() && input.getHeight() == output.getHeight());
+
+	enum { MAX_SPAN = 8 };
+	const float REDUCE_MIN = 1.f / 128.f;
+	const float REDUCE_MUL = 1.f / 8.f;
+	const float EDGE_THRESHOLD = 1.f / 8.f;
+	const float EDGE_THRESHOLD_MIN = 1.f / 32.f;
+
+	//luma of all pixels first, each one is read by 9 neighbours
+	const int32_t width = input.getWidth(), height = input.getHeight();
+	PixelBuffer<float> luma;
+	luma.init(width, height, 0.f);
+	Parallel::parallelForTiles(width, height, TILE_SIZE, [&input, &luma, width](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		for (int32_t y = y0; y < y1; y++) {
+			for (int32_t x = x0; x < x1; x++) {
+				luma.ptr()[y*width + x] = _luma(input.ptr()[y*width + x]);
+			}
+		}
+	});
+
+	Parallel::parallelForTiles(width, height, TILE_SIZE, [&](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		for (int32_t y = y0; y < y1; y++) {
+			for (int32_t x = x0; x < x1; x++) {
+				const fVector4& colorM = input.ptr()[y*width + x];
+				float lumaM = luma.ptr()[y*width + x];
+				float lumaNW = _fetch(luma, x - 1, y - 1), lumaNE = _fetch(luma, x + 1, y - 1);
+				float lumaSW = _fetch(luma, x - 1, y + 1), lumaSE = _fetch(luma, x + 1, y + 1);
+
+				float lumaMin = MathUtil::min2(lumaM, MathUtil::min2(MathUtil::min2(lumaNW, lumaNE), MathUtil::min2(lumaSW, lumaSE)));
+				float lumaMax = MathUtil::max2(lumaM, MathUtil::max2(MathUtil::max2(lumaNW, lumaNE), MathUtil::max2(lumaSW, lumaSE)));
+
+				//not an edge, most of pixels stop here
+				if (lumaMax - lumaMin < MathUtil::max2(EDGE_THRESHOLD_MIN, lumaMax*EDGE_THRESHOLD)) {
+					output.ptr()[y*width + x] = colorM;
+					continue;
+				}
+
+				//blur along the edge
+				float dirX = -((lumaNW + lumaNE) - (lumaSW + lumaSE));
+				float dirY = ((lumaNW + lumaSW) - (lumaNE + lumaSE));
+				float dirReduce = MathUtil::max2((lumaNW + lumaNE + lumaSW + lumaSE)*(0.25f*REDUCE_MUL), REDUCE_MIN);
+				float rcpDirMin = 1.f / (MathUtil::min2(fabsf(dirX), fabsf(dirY)) + dirReduce);
+				dirX = MathUtil::saturate(dirX*rcpDirMin, -(float)MAX_SPAN, (float)MAX_SPAN);
+				dirY = MathUtil::saturate(dirY*rcpDirMin, -(float)MAX_SPAN, (float)MAX_SPAN);
+
+				float cx = x + 0.5f, cy = y + 0.5f;
+				fVector4 colorA = (_sampleBilinear(input, cx + dirX*(1.f / 3.f - 0.5f), cy + dirY*(1.f / 3.f - 0.5f)) +
+					_sampleBilinear(input, cx + dirX*(2.f / 3.f - 0.5f), cy + dirY*(2.f / 3.f - 0.5f)))*0.5f;
+				fVector4 colorB = colorA*0.5f + (_sampleBilinear(input, cx - dirX*0.5f, cy - dirY*0.5f) +
+					_sampleBilinear(input, cx + dirX*0.5f, cy + dirY*0.5f))*0.25f;
+
+				//the wider taps crossed another edge
+				float lumaB = _luma(colorB);
+				fVector4 color = (lumaB < lumaMin || lumaB > lumaMax) ? colorA : colorB;
+				color.w = colorM.w;
+				output.ptr()[y*width + x] = color;
+			}
+		}
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void PostProcess::gaussianBlur(const PixelBuffer<fVector4>& input, int32_t radius, float sigma, PixelBuffer<fVector4>& temp, PixelBuffer<fVector4>& output)
+{
+	assert(&input != &temp && &temp != &output);
+	assert(radius >= 0 && sigma > 0.f);
+	assert(input.getWidth() == temp.getWidth() && input.getHeight() == temp.getHeight());
+	assert(input.getWidth() == output.getWidth() && input.getHeight() == output.getHeight());
+
+	const int32_t width = input.getWidth(), height = input.getHeight();
+
+	//normalised weights of [-radius, radius]
+	std::vector<float> weights((size_t)(radius * 2 + 1));
+	float sum = 0.f;
+	for (int32_t i = -radius; i <= radius; i++) {
+		weights[(size_t)(i + radius)] = expf(-(float)(i*i) / (2.f*sigma*sigma));
+		sum += weights[(size_t)(i + radius)];
+	}
+	for (float& weight : weights) weight /= sum;
+
+	//horizontal
+	Parallel::parallelForTiles(width, height, TILE_SIZE, [&input, &temp, &weights, width, radius](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		for (int32_t y = y0; y < y1; y++) {
+			const fVector4* src = input.ptr() + y*width;
+			fVector4* dest = temp.ptr() + y*width;
+
+			for (int32_t x = x0; x < x1; x++) {
+				fVector4 color(0.f, 0.f, 0.f, 0.f);
+				for (int32_t i = -radius; i <= radius; i++) {
+					color += src[MathUtil::saturate(x + i, 0, width - 1)] * weights[(size_t)(i + radius)];
+				}
+				dest[x] = color;
+			}
+		}
+	});
+
+	//vertical, accumulate whole rows of the tile so the inner loop is contiguous floats
+	Parallel::parallelForTiles(width, height, TILE_SIZE, [&temp, &output, &weights, width, height, radius](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		const int32_t counts = (x1 - x0) * 4;
+
+		for (int32_t y = y0; y < y1; y++) {
+			float* dest = (float*)(output.ptr() + y*width + x0);
+			for (int32_t i = 0; i < counts; i++) dest[i] = 0.f;
+
+			for (int32_t k = -radius; k <= radius; k++) {
+				const float* src = (const float*)(temp.ptr() + MathUtil::saturate(y + k, 0, height - 1)*width + x0);
+				const float weight = weights[(size_t)(k + radius)];
+				for (int32_t i = 0; i < counts; i++) dest[i] += src[i] * weight;
+			}
+		}
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void PostProcess::downsample(const PixelBuffer<fVector4>& input, PixelBuffer<fVector4>& output)
+{
+	assert(output.getWidth() == (input.getWidth() + 1) / 2 && output.getHeight() == (input.getHeight() + 1) / 2);
+
+	Parallel::parallelForTiles(output.getWidth(), output.getHeight(), TILE_SIZE, [&input, &output](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		for (int32_t y = y0; y < y1; y++) {
+			for (int32_t x = x0; x < x1; x++) {
+				fVector4 color = _fetch(input, x * 2, y * 2) + _fetch(input, x * 2 + 1, y * 2) + 
+					_fetch(input, x * 2, y * 2 + 1) + _fetch(input, x * 2 + 1, y * 2 + 1);
+				output.ptr()[y*output.getWidth() + x] = color*0.25f;
+			}
+		}
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void PostProcess::downsampleDepth(const PixelBuffer<float>& input, PixelBuffer<float>& output)
+{
+	assert(output.getWidth() == (input.getWidth() + 1) / 2 && output.getHeight() == (input.getHeight() + 1) / 2);
+
+	Parallel::parallelForTiles(output.getWidth(), output.getHeight(), TILE_SIZE, [&input, &output](int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+		for (int32_t y = y0; y < y1; y++) {
+			for (int32_t x = x0; x < x1; x++) {
+				float depth = MathUtil::max2(MathUtil::max2(_fetch(input, x * 2, y * 2), _fetch(input, x * 2 + 1, y * 2)),
+					MathUtil::max2(_fetch(input, x * 2, y * 2 + 1), _fetch(input, x * 2 + 1, y * 2 + 1)));
+				output.ptr()[y*output.getWidth() + x] = depth;
+			}
+		}
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void PostProcess::buildMipChain(const PixelBuffer<fVector4>& input, MipChain<fVector4>& chain)
+{
+	for (size_t i = 0; i < chain.getLevelCounts(); i++) {
+		downsample(i == 0 ? input : chain.getLevel(i - 1), chain.getLevel(i));
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void PostProcess::buildDepthMipChain(const PixelBuffer<float>& input, MipChain<float>& chain)
+{
+	for (size_t i = 0; i < chain.getLevelCounts(); i++) {
+		downsampleDepth(i == 0 ? input : chain.getLevel(i - 1), chain.getLevel(i));
+	}
+}
+
+}
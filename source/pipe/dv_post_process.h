@@ -0,0 +1,67 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+//to be remove
+#include "device/dv_pixel_buffer.h"
+
+namespace davinci
+{
+
+//Mip levels of a surface, level 0 is half size of the source(odd sizes are rounded up)
+template<typename T>
+class MipChain : noncopyable
+{
+public:
+	size_t getLevelCounts(void) const { return m_levels.size(); }
+	const PixelBuffer<T>& getLevel(size_t level) const { return *(m_levels[level]); }
+	PixelBuffer<T>& getLevel(size_t level) { return *(m_levels[level]); }
+
+	//allocate levels for a width*height source, stop at 1x1
+	void init(int32_t width, int32_t height, size_t levelCounts, const T& clearValue) {
+		m_levels.clear();
+		for (size_t i = 0; i < levelCounts && (width > 1 || height > 1); i++) {
+			width = (width + 1) / 2;
+			height = (height + 1) / 2;
+
+			m_levels.push_back(std::unique_ptr<PixelBuffer<T>>(new PixelBuffer<T>()));
+			m_levels.back()->init(width, height, clearValue);
+		}
+	}
+
+private:
+	std::vector<std::unique_ptr<PixelBuffer<T>>> m_levels;
+};
+
+//Image-space passes over color and depth buffers, every pass is split into tiles which run in parallel.
+//Passes read input and write output, they can be chained on RenderTarget::getColorBuffer/getDepthBuffer
+class PostProcess
+{
+public:
+	enum { TILE_SIZE = 64 };
+
+	enum ToneMapOperator
+	{
+		TM_CLAMP,		//saturate only
+		TM_REINHARD,	//c/(1+c)
+		TM_ACES,		//filmic curve fitted to ACES
+	};
+
+	//color*exposure then tonemap, encode to sRGB if required. alpha is kept, input and output can be the same buffer
+	static void toneMap(const PixelBuffer<fVector4>& input, float exposure, ToneMapOperator op, bool sRGB, PixelBuffer<fVector4>& output);
+	//fast approximate anti-aliasing on a tonemapped(LDR) image, input and output must be different buffers
+	static void fxaa(const PixelBuffer<fVector4>& input, PixelBuffer<fVector4>& output);
+	//separable gaussian blur, horizontal into temp then vertical into output. 
+	//input and output can be the same buffer, temp must be different
+	static void gaussianBlur(const PixelBuffer<fVector4>& input, int32_t radius, float sigma, PixelBuffer<fVector4>& temp, PixelBuffer<fVector4>& output);
+
+	//2x2 box filter to next level(eg. bloom)
+	static void downsample(const PixelBuffer<fVector4>& input, PixelBuffer<fVector4>& output);
+	//farthest depth of 2x2 pixels, a conservative depth pyramid(Hi-Z)
+	static void downsampleDepth(const PixelBuffer<float>& input, PixelBuffer<float>& output);
+	//downsample level by level, chain must be initialised(MipChain::init) with size of input
+	static void buildMipChain(const PixelBuffer<fVector4>& input, MipChain<fVector4>& chain);
+	static void buildDepthMipChain(const PixelBuffer<float>& input, MipChain<float>& chain);
+};
+
+}
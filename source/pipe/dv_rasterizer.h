@@ -20,22 +20,32 @@ public:
 public:
 	typedef std::function<void(const std::pair<int32_t, int32_t>&, const fVector3&)> DrawTriangleCallback;
 
-	struct DebugParam
-	{
-		bool debug;
-		int32_t x;
-		int32_t y;
-		int32_t tile_id;
-		int32_t coarse_id;
-		int32_t fine_id;
-		int32_t edge_id;
-	};
-
 	//Larrabee algorithm
 	static void drawTriangleLarrabee(int32_t canvasWidth, int32_t canvasHeight, 
 		const fVector3& v0, const fVector3& v1, const fVector3& v2, 
-		DrawTriangleCallback callback, 
-		const DebugParam* debug=nullptr);
+		DrawTriangleCallback callback);
+
+	//same as drawTriangleLarrabee, but the callback is a template parameter which can be inlined into 
+	//the traversal loops, include "pipe/dv_rasterizer_larrabee.h" to use it
+	template<typename Callback>
+	static void drawTriangleLarrabeeT(int32_t canvasWidth, int32_t canvasHeight,
+		const fVector3& v0, const fVector3& v1, const fVector3& v2,
+		Callback& callback);
+
+	//same traversal, callback(x0, y0, mask, percents) is called once for each 4x4 block with covered pixels, 
+	//bit i of mask is pixel(x0 + i%4, y0 + i/4) and percents[i] is its barycentric coordinate(only covered ones are valid)
+	template<typename BlockCallback>
+	static void drawTriangleLarrabeeBlockT(int32_t canvasWidth, int32_t canvasHeight,
+		const fVector3& v0, const fVector3& v1, const fVector3& v2,
+		BlockCallback& callback);
+
+	//edge function of p against edge a->b, twice the signed area of triangle(a, b, p)
+	static float edge(const fVector3& a, const fVector3& b, const fVector3& p) {
+		return (p.x - a.x) * (b.y - a.y) - (p.y - a.y) * (b.x - a.x);
+	}
+
+	//perspective-correct barycentric coordinate of pixel(x,y), the same value passed to DrawTriangleCallback
+	static fVector3 barycentric(const fVector3& v0, const fVector3& v1, const fVector3& v2, int32_t x, int32_t y);
 
 	//Scaleline algorithm
 	static void drawTriangleScanline(int32_t canvasWidth, int32_t canvasHeight,
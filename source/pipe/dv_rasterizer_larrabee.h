@@ -0,0 +1,416 @@
+#pragma once
+
+#include "dv_rasterizer.h"
+#include "math/dv_fixmath.h"
+
+/*
+https://github.com/nlguillemot/vigilant-system
+
+Larrabee traversal is templated on the pixel callback, so a lambda passed to
+Rasterizer::drawTriangleLarrabeeT is inlined into the fine block loop.
+*/
+
+namespace davinci
+{
+
+//traversal internals, only used by the templates of Rasterizer below
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------
+#define ifloat3_element(a) { a[0], a[1], a[2] }
+
+//-------------------------------------------------------------------------------------
+struct DrawTriangleParam
+{
+	int32_t		widthInPixel;
+	int32_t		heightInPixel;
+	int32_t		widthInTiles;
+	fVector3		verts[3];
+	float		bbox_min_x;
+	float		bbox_max_x;
+	float		bbox_min_y;
+	float		bbox_max_y;
+	bool		tlBorder[3];
+	float		area;
+	ifloat3_t	edgesDX, edgesDY;
+};
+
+//-------------------------------------------------------------------------------------
+enum { TILE_WIDTH_IN_PIXELS = 64, COARSE_BLOCK_WIDTH_IN_PIXELS = 16, FINE_BLOCK_WIDTH_IN_PIXELS = 4 };
+
+//-------------------------------------------------------------------------------------
+template<typename Callback>
+inline void _drawTriangle_Fine(int32_t tile_id, int32_t coarse_id, int32_t fine_id,
+	const DrawTriangleParam& param, const ifloat3_t& edges0, uint32_t testEdgeMask, 
+	Callback& callback)
+{
+	ifloat3_t pixelEdges = ifloat3_element(edges0);
+
+	const fVector3 v0(param.verts[0]), v1(param.verts[1]), v2(param.verts[2]);
+
+	int32_t fine_start_x = (tile_id%param.widthInTiles) * TILE_WIDTH_IN_PIXELS + (coarse_id % 4)*COARSE_BLOCK_WIDTH_IN_PIXELS + (fine_id % 4)*FINE_BLOCK_WIDTH_IN_PIXELS;
+	int32_t fine_start_y = (tile_id / param.widthInTiles) * TILE_WIDTH_IN_PIXELS + (coarse_id / 4) * COARSE_BLOCK_WIDTH_IN_PIXELS + (fine_id / 4)*FINE_BLOCK_WIDTH_IN_PIXELS;
+
+	//coverage of the fine block, bit i is pixel(fine_start_x + i%4, fine_start_y + i/4)
+	uint32_t mask = 0;
+	fVector3 percents[FINE_BLOCK_WIDTH_IN_PIXELS*FINE_BLOCK_WIDTH_IN_PIXELS];
+
+	for (int32_t y_index=0, y= fine_start_y; y_index < 4; y_index++, y++) {
+		ifloat3_t edgesRow = ifloat3_element(pixelEdges);
+
+		for (int32_t x_index = 0, x=fine_start_x; x_index < 4; x_index++, x++) {
+
+			bool rejected =
+				((testEdgeMask & 1) && (edgesRow[0] < 0 || (!param.tlBorder[0] && edgesRow[0] == 0))) ||
+				((testEdgeMask & 2) && (edgesRow[1] < 0 || (!param.tlBorder[1] && edgesRow[1] == 0))) ||
+				((testEdgeMask & 4) && (edgesRow[2] < 0 || (!param.tlBorder[2] && edgesRow[2] == 0)));
+			
+			if (!rejected) {
+
+				fVector3 pixel(x + 0.5f, y + 0.5f, 0.f);
+				float w0 = Rasterizer::edge(v1, v2, pixel);
+				float w1 = Rasterizer::edge(v2, v0, pixel);
+				float w2 = Rasterizer::edge(v0, v1, pixel);
+
+				fVector3 t = fVector3(w0 / param.area, w1 / param.area, w2 / param.area);
+
+				float invZ = MathUtil::lerp3(v0.z, v1.z, v2.z, t);
+				t *= fVector3(v0.z / invZ, v1.z / invZ, v2.z / invZ);
+
+				mask |= 1u << (y_index * 4 + x_index);
+				percents[y_index * 4 + x_index] = t;
+			}
+			ifloat3_add(edgesRow, param.edgesDY);
+		}
+		ifloat3_sub(pixelEdges, param.edgesDX);
+	}
+
+	if (mask != 0) {
+		callback(fine_start_x, fine_start_y, mask, percents);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+template<typename Callback>
+inline void _drawTriangle_Coarse(int32_t tile_id, int32_t coarse_id,
+	DrawTriangleParam& param, const ifloat3_t& edges0, uint32_t testEdgeMask, 
+	Callback& callback)
+{
+	const ifloat3_t blockEdgesDX = { param.edgesDX[0] * FINE_BLOCK_WIDTH_IN_PIXELS, param.edgesDX[1] * FINE_BLOCK_WIDTH_IN_PIXELS, param.edgesDX[2] * FINE_BLOCK_WIDTH_IN_PIXELS };
+	const ifloat3_t blockEdgesDY = { param.edgesDY[0] * FINE_BLOCK_WIDTH_IN_PIXELS, param.edgesDY[1] * FINE_BLOCK_WIDTH_IN_PIXELS, param.edgesDY[2] * FINE_BLOCK_WIDTH_IN_PIXELS };
+
+	ifloat3_t blockReject = ifloat3_element(edges0);
+	ifloat3_t blockAccept = ifloat3_element(edges0);
+	ifloat3_t blockEdges = ifloat3_element(edges0);
+
+	for (size_t v = 0; v < 3; v++) {
+		if (testEdgeMask & (1 << v)) {	
+			if (blockEdgesDX[v] > 0) blockAccept[v] -= blockEdgesDX[v];
+			if (blockEdgesDX[v] < 0) blockReject[v] -= blockEdgesDX[v];
+			if (blockEdgesDY[v] < 0) blockAccept[v] += blockEdgesDY[v];
+			if (blockEdgesDY[v] > 0) blockReject[v] += blockEdgesDY[v];
+		}
+	}
+
+	int32_t block_start_x = (tile_id%param.widthInTiles) * TILE_WIDTH_IN_PIXELS + (coarse_id % 4)*COARSE_BLOCK_WIDTH_IN_PIXELS;
+	int32_t block_start_y = (tile_id / param.widthInTiles) * TILE_WIDTH_IN_PIXELS + (coarse_id / 4) * COARSE_BLOCK_WIDTH_IN_PIXELS;
+
+	for (int32_t y_index = 0; y_index < 4; y_index++) {
+		if (block_start_y + y_index*FINE_BLOCK_WIDTH_IN_PIXELS > param.bbox_max_y) break;
+		if (block_start_y + (y_index + 1)*FINE_BLOCK_WIDTH_IN_PIXELS >= param.bbox_min_y) {
+
+			ifloat3_t edgesRow = ifloat3_element(blockEdges);
+			ifloat3_t edgesRowReject = { 0 }, edgesRowAccept = { 0 };
+
+			for (size_t v = 0; v < 3; v++) {
+				if (testEdgeMask & (1 << v)) {
+					edgesRowReject[v] = blockReject[v];
+					edgesRowAccept[v] = blockAccept[v];
+				}
+			}
+			for (int32_t x_index = 0; x_index < 4; x_index++) {
+				if (block_start_x + x_index*FINE_BLOCK_WIDTH_IN_PIXELS > param.bbox_max_x) break;
+				if (block_start_x + (x_index + 1)*FINE_BLOCK_WIDTH_IN_PIXELS >= param.bbox_min_x) {
+
+					bool rejected = 
+						((testEdgeMask & 1) && (edgesRowReject[0] < 0 || (!param.tlBorder[0] && edgesRowReject[0] == 0))) ||
+						((testEdgeMask & 2) && (edgesRowReject[1] < 0 || (!param.tlBorder[1] && edgesRowReject[1] == 0))) ||
+						((testEdgeMask & 4) && (edgesRowReject[2] < 0 || (!param.tlBorder[2] && edgesRowReject[2] == 0)));
+
+					if (!rejected) {
+						uint32_t newTestEdgeMask = testEdgeMask;
+						for (size_t v = 0; v < 3; v++) {
+							if (testEdgeMask & (1 << v)) {
+								if (edgesRowAccept[v] > 0 || (edgesRowAccept[v] == 0 && param.tlBorder[v])) {
+									newTestEdgeMask &= ~(1 << v);
+								}
+							}
+						}
+
+						_drawTriangle_Fine(tile_id, coarse_id, y_index * 4 + x_index, param, edgesRow, newTestEdgeMask, callback);
+					}
+				}
+				ifloat3_add(edgesRow, blockEdgesDY);
+
+				for (size_t v = 0; v < 3; v++) {
+					if (testEdgeMask & (1 << v)) {
+
+						edgesRowReject[v] += blockEdgesDY[v];
+						edgesRowAccept[v] += blockEdgesDY[v];
+					}
+				}
+			}
+		}
+		ifloat3_sub(blockEdges, blockEdgesDX);
+
+		for (size_t v = 0; v < 3; v++) {
+			if (testEdgeMask & (1 << v)) {
+				blockReject[v] -= blockEdgesDX[v];
+				blockAccept[v] -= blockEdgesDX[v];
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+template<typename Callback>
+inline void _drawTriangle_Title(int32_t tile_id,
+	DrawTriangleParam& param, const ifloat3_t& edges0, uint32_t testEdgeMask, 
+	Callback& callback)
+{
+	const ifloat3_t blockEdgesDX = { param.edgesDX[0] * COARSE_BLOCK_WIDTH_IN_PIXELS, param.edgesDX[1] * COARSE_BLOCK_WIDTH_IN_PIXELS, param.edgesDX[2] * COARSE_BLOCK_WIDTH_IN_PIXELS };
+	const ifloat3_t blockEdgesDY = { param.edgesDY[0] * COARSE_BLOCK_WIDTH_IN_PIXELS, param.edgesDY[1] * COARSE_BLOCK_WIDTH_IN_PIXELS, param.edgesDY[2] * COARSE_BLOCK_WIDTH_IN_PIXELS };
+
+	ifloat3_t blockReject = ifloat3_element(edges0);
+	ifloat3_t blockAccept = ifloat3_element(edges0);
+	ifloat3_t blockEdges = ifloat3_element(edges0);
+
+	for (size_t v = 0; v < 3; v++) {
+		if (testEdgeMask & (1 << v)) {
+			if (blockEdgesDX[v] > 0) blockAccept[v] -= blockEdgesDX[v];
+			if (blockEdgesDX[v] < 0) blockReject[v] -= blockEdgesDX[v];
+			if (blockEdgesDY[v] < 0) blockAccept[v] += blockEdgesDY[v];
+			if (blockEdgesDY[v] > 0) blockReject[v] += blockEdgesDY[v];
+		}
+	}
+
+	int32_t block_start_x = (tile_id%param.widthInTiles) * TILE_WIDTH_IN_PIXELS;
+	int32_t block_start_y = (tile_id / param.widthInTiles) * TILE_WIDTH_IN_PIXELS;
+
+	for (int32_t y_index = 0; y_index < 4; y_index++) {
+		if (block_start_y + y_index*COARSE_BLOCK_WIDTH_IN_PIXELS > param.bbox_max_y) break;
+		if (block_start_y + (y_index + 1)*COARSE_BLOCK_WIDTH_IN_PIXELS >= param.bbox_min_y) {
+
+			ifloat3_t edges = ifloat3_element(blockEdges);
+			ifloat3_t edgesRowReject = { 0 }, edgesRowAccept = { 0 };
+
+			for (size_t v = 0; v < 3; v++) {
+				if (testEdgeMask & (1 << v)) {
+					edgesRowReject[v] = blockReject[v];
+					edgesRowAccept[v] = blockAccept[v];
+				}
+			}
+
+			for (int32_t x_index = 0; x_index < 4; x_index++) {
+				if (block_start_x + x_index*COARSE_BLOCK_WIDTH_IN_PIXELS > param.bbox_max_x) break;
+				if (block_start_x + (x_index + 1)*COARSE_BLOCK_WIDTH_IN_PIXELS >= param.bbox_min_x) {
+
+					bool rejected = 
+						((testEdgeMask & 1) && (edgesRowReject[0] < 0 || (!param.tlBorder[0] && edgesRowReject[0] == 0))) ||
+						((testEdgeMask & 2) && (edgesRowReject[1] < 0 || (!param.tlBorder[1] && edgesRowReject[1] == 0))) ||
+						((testEdgeMask & 4) && (edgesRowReject[2] < 0 || (!param.tlBorder[2] && edgesRowReject[2] == 0)));
+
+					if (!rejected) {
+
+						uint32_t newTestEdgeMask = testEdgeMask;
+						for (size_t v = 0; v < 3; v++) {
+							if (testEdgeMask & (1 << v)) {
+								if (edgesRowAccept[v] > 0 || (edgesRowAccept[v] == 0 && param.tlBorder[v])) {
+									newTestEdgeMask &= ~(1 << v);
+								}
+							}
+						}
+						_drawTriangle_Coarse(tile_id, y_index * 4 + x_index, param, edges, newTestEdgeMask, callback);
+					}
+				}
+
+				ifloat3_add(edges, blockEdgesDY);
+
+				for (size_t v = 0; v < 3; v++) {
+					if (testEdgeMask & (1 << v)) {
+						edgesRowReject[v] += blockEdgesDY[v];
+						edgesRowAccept[v] += blockEdgesDY[v];
+					}
+				}
+			}
+		}
+
+		ifloat3_sub(blockEdges, blockEdgesDX);
+		for (size_t v = 0; v < 3; v++) {
+			if (testEdgeMask & (1 << v)) {
+				blockReject[v] -= blockEdgesDX[v];
+				blockAccept[v] -= blockEdgesDX[v];
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+//pixel callback of drawTriangleLarrabeeT, called for the covered pixels of each fine block in order
+template<typename Callback>
+struct _PixelOfBlockCallback
+{
+	Callback& callback;
+
+	void operator()(int32_t x0, int32_t y0, uint32_t mask, const fVector3* percents) {
+		for (int32_t i = 0; i < FINE_BLOCK_WIDTH_IN_PIXELS*FINE_BLOCK_WIDTH_IN_PIXELS; i++) {
+			if (mask & (1u << i)) {
+				callback(std::make_pair(x0 + (i % FINE_BLOCK_WIDTH_IN_PIXELS), y0 + (i / FINE_BLOCK_WIDTH_IN_PIXELS)), percents[i]);
+			}
+		}
+	}
+};
+
+}
+
+//-------------------------------------------------------------------------------------
+template<typename Callback>
+void Rasterizer::drawTriangleLarrabeeT(int32_t canvasWidth, int32_t canvasHeight, const fVector3& v0, const fVector3& v1, const fVector3& v2, Callback& callback)
+{
+	detail::_PixelOfBlockCallback<Callback> blockCallback = { callback };
+	drawTriangleLarrabeeBlockT(canvasWidth, canvasHeight, v0, v1, v2, blockCallback);
+}
+
+//-------------------------------------------------------------------------------------
+template<typename BlockCallback>
+void Rasterizer::drawTriangleLarrabeeBlockT(int32_t canvasWidth, int32_t canvasHeight, const fVector3& v0, const fVector3& v1, const fVector3& v2, BlockCallback& callback)
+{
+	using namespace detail;
+
+	assert(canvasWidth >= TILE_WIDTH_IN_PIXELS && canvasHeight >= TILE_WIDTH_IN_PIXELS);
+	assert(canvasWidth%TILE_WIDTH_IN_PIXELS == 0 && canvasHeight%canvasHeight == 0);
+
+	DrawTriangleParam param;
+	param.widthInPixel = canvasWidth;
+	param.heightInPixel = canvasHeight;
+	param.widthInTiles = canvasWidth / TILE_WIDTH_IN_PIXELS;
+
+	//only clockwise triangles can be rasterized, culling is done by PrimitiveAssembler before rasterization
+	fVector3 vnormal = (v2 - v1).crossProduct(v0 - v2);
+	if (vnormal.z > 0) return;
+
+	//to screen space(integer)
+	const fVector3 verts[3] = { v0, v1, v2 };
+	param.verts[0] = verts[0];
+	param.verts[1] = verts[1];
+	param.verts[2] = verts[2];
+	param.area = Rasterizer::edge(v0, v1, v2);
+
+	ifloat2_t vertices[3];
+	for (size_t i = 0; i<3; i++) for (size_t j = 0; j<2; j++)
+		vertices[i][j] = ifloat_init(verts[i][j]);
+
+	//get window coordinates bounding box
+	param.bbox_min_x = MathUtil::min3(v0.x, v1.x, v2.x);
+	param.bbox_max_x = MathUtil::max3(v0.x, v1.x, v2.x);
+	param.bbox_min_y = MathUtil::min3(v0.y, v1.y, v2.y);
+	param.bbox_max_y = MathUtil::max3(v0.y, v1.y, v2.y);
+
+	//canvas size
+	ifloat_t iCanvasWidth = ifloat_init(canvasWidth);
+	ifloat_t iCanvasHeight = ifloat_init(canvasHeight);
+
+	// clip triangles that are fully outside the scissor rect (scissor rect = whole window)
+	if (param.bbox_max_x < 0 || param.bbox_max_y < 0 || param.bbox_min_x >= canvasWidth || param.bbox_min_y >= canvasHeight) {
+		return;
+	}
+	if (param.bbox_min_x < 0) param.bbox_min_x = 0;
+	if (param.bbox_min_y < 0) param.bbox_min_y = 0;
+	if (param.bbox_max_x > canvasWidth - 1.f) param.bbox_max_x = canvasWidth - 1.f;
+	if (param.bbox_max_y > canvasHeight - 1.f) param.bbox_max_y = canvasHeight - 1.f;
+
+	// tile range
+	int32_t first_tile_x = (int32_t)(param.bbox_min_x / TILE_WIDTH_IN_PIXELS);
+	int32_t first_tile_y = (int32_t)(param.bbox_min_y / TILE_WIDTH_IN_PIXELS);
+	int32_t last_tile_x = (int32_t)(param.bbox_max_x / TILE_WIDTH_IN_PIXELS);
+	int32_t last_tile_y = (int32_t)(param.bbox_max_y / TILE_WIDTH_IN_PIXELS);
+
+	// evaluate edge equation at the top left tile
+	ifloat_t firstTileX = first_tile_x * ifloat_init(TILE_WIDTH_IN_PIXELS);
+	ifloat_t firstTileY = first_tile_y * ifloat_init(TILE_WIDTH_IN_PIXELS);
+
+	ifloat3_t edges0;
+	ifloat3_t tileEdgesDX, tileEdgesDY, edgesReject, edgesAccept;
+	const ifloat_t kZeroPointFive = ifloat_init(0.5f);
+
+	for (size_t v = 0; v < 3; v++)
+	{
+		size_t v_end = (v + 1) % 3;
+		param.edgesDX[v] = vertices[v_end][0] - vertices[v][0];
+		param.edgesDY[v] = vertices[v_end][1] - vertices[v][1];
+
+		tileEdgesDX[v] = param.edgesDX[v] * TILE_WIDTH_IN_PIXELS;
+		tileEdgesDY[v] = param.edgesDY[v] * TILE_WIDTH_IN_PIXELS;
+
+		edges0[v] = (firstTileX + kZeroPointFive - vertices[v][0]) * param.edgesDY[v] - (firstTileY + kZeroPointFive - vertices[v][1])*param.edgesDX[v];
+		edges0[v] = ifloat_get_int(edges0[v]); //after multi
+
+		// Top-left rule: shift top-left edges ever so slightly outward to make the top-left edges be the tie-breakers when rasterizing adjacent triangles
+		if ((vertices[v_end][1] == vertices[v][1] && vertices[v_end][0] > vertices[v][0]) || vertices[v_end][1] > vertices[v][1]) param.tlBorder[v] = true;
+		else param.tlBorder[v] = false;
+
+		edgesReject[v] = edgesAccept[v] = edges0[v];
+		if (tileEdgesDX[v] > 0) edgesAccept[v] -= tileEdgesDX[v];
+		if (tileEdgesDX[v] < 0) edgesReject[v] -= tileEdgesDX[v];
+		if (tileEdgesDY[v] < 0) edgesAccept[v] += tileEdgesDY[v];
+		if (tileEdgesDY[v] > 0) edgesReject[v] += tileEdgesDY[v];
+	}
+
+	ifloat3_t rowEdges = ifloat3_element(edges0);
+
+	int32_t tile_row_start = first_tile_y * param.widthInTiles + first_tile_x;
+	for (int32_t tile_y = first_tile_y; tile_y <= last_tile_y; tile_y++)
+	{
+		ifloat3_t edges = ifloat3_element(rowEdges);
+		ifloat3_t tileEdgesReject = ifloat3_element(edgesReject);
+		ifloat3_t tileEdgesAccept = ifloat3_element(edgesAccept);
+
+		int32_t tile_i = tile_row_start;
+		for (int32_t tile_x = first_tile_x; tile_x <= last_tile_x; tile_x++) {
+
+			bool rejected =
+				((tileEdgesReject[0] < 0 || (!param.tlBorder[0] && tileEdgesReject[0] == 0))) ||
+				((tileEdgesReject[1] < 0 || (!param.tlBorder[1] && tileEdgesReject[1] == 0))) ||
+				((tileEdgesReject[2] < 0 || (!param.tlBorder[2] && tileEdgesReject[2] == 0)));
+
+			if (!rejected) {
+				//draw title
+				uint32_t testEdgeMask = 0;
+				for (size_t v = 0; v < 3; v++) {
+					if (tileEdgesAccept[v] < 0 || (tileEdgesAccept[v] == 0 && !param.tlBorder[v])) {
+						testEdgeMask += (1 << v);
+					}
+				}
+
+				_drawTriangle_Title(tile_i, param, edges, testEdgeMask, callback);
+			}
+
+			//x setp
+			ifloat3_add(edges, tileEdgesDY);
+			ifloat3_add(tileEdgesReject, tileEdgesDY);
+			ifloat3_add(tileEdgesAccept, tileEdgesDY);
+			tile_i++;
+		}
+
+		//y step
+		ifloat3_sub(rowEdges, tileEdgesDX);
+		ifloat3_sub(edgesReject, tileEdgesDX);
+		ifloat3_sub(edgesAccept, tileEdgesDX);
+		tile_row_start += param.widthInTiles;
+	}
+}
+
+}
+
+#undef ifloat3_element
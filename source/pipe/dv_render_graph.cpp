@@ -0,0 +1,312 @@
+#include "dv_precompiled.h"
+#include "dv_render_graph.h"
+
+#include "device/dv_render_target.h"
+#include "device/dv_depth_buffer.h"
+#include "device/dv_gbuffer.h"
+#include "device/dv_render_target_set.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+size_t RenderGraph::_getPixelSize(PixelFormat format)
+{
+	return RenderTargetSet::getPixelSize(format);
+}
+
+//-------------------------------------------------------------------------------------
+RenderGraph::ResourceHandle RenderGraph::_addSurface(const char* name, SurfaceType type, int32_t width, int32_t height, size_t size, std::shared_ptr<void> surface, InitFunction init)
+{
+	assert(width > 0 && height > 0);
+
+	Resource resource;
+	resource.name = name;
+	resource.imported = false;
+	resource.type = type;
+	resource.desc.width = width;
+	resource.desc.height = height;
+	resource.desc.format = PF_FLOAT32_RGBA;
+	resource.size = size;
+	resource.surface = surface;
+	resource.init = init;
+	resource.firstLevel = resource.lastLevel = -1;
+	resource.block = -1;
+
+	m_resources.push_back(resource);
+	return (ResourceHandle)(m_resources.size() - 1);
+}
+
+//-------------------------------------------------------------------------------------
+template<typename T>
+RenderGraph::ResourceHandle RenderGraph::_addPixelSurface(const char* name, const SurfaceDesc& desc)
+{
+	assert(sizeof(T) == _getPixelSize(desc.format));
+	int32_t width = desc.width, height = desc.height;
+
+	PixelBuffer<T>* surface = new PixelBuffer<T>();
+	ResourceHandle handle = _addSurface(name, ST_PIXELS, width, height, PixelBuffer<T>::getMemorySize(width, height), std::shared_ptr<void>(surface),
+		[surface, width, height](uint8_t* storage) { surface->init(width, height, T(), storage); });
+
+	m_resources[(size_t)handle].desc.format = desc.format;
+	return handle;
+}
+
+//-------------------------------------------------------------------------------------
+RenderGraph::ResourceHandle RenderGraph::createSurface(const char* name, const SurfaceDesc& desc)
+{
+	switch (desc.format) {
+	case PF_FLOAT32_RGB: return _addPixelSurface<fVector3>(name, desc);
+	case PF_FLOAT32_RGBA: return _addPixelSurface<fVector4>(name, desc);
+	case PF_FLOAT32_R: return _addPixelSurface<float>(name, desc);
+	case PF_FLOAT32_RG: return _addPixelSurface<fVector2>(name, desc);
+	case PF_UINT8_RGBA:
+	case PF_UINT32_R: return _addPixelSurface<uint32_t>(name, desc);
+	default: assert(false); return INVALID_HANDLE;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+RenderGraph::ResourceHandle RenderGraph::createRenderTarget(const char* name, int32_t width, int32_t height)
+{
+	RenderTarget* surface = new RenderTarget();
+	return _addSurface(name, ST_RENDER_TARGET, width, height, RenderTarget::getMemorySize(width, height), std::shared_ptr<void>(surface),
+		[surface, width, height](uint8_t* storage) { surface->init(width, height, storage); });
+}
+
+//-------------------------------------------------------------------------------------
+RenderGraph::ResourceHandle RenderGraph::createDepthBuffer(const char* name, int32_t width, int32_t height)
+{
+	DepthBuffer* surface = new DepthBuffer();
+	return _addSurface(name, ST_DEPTH_BUFFER, width, height, DepthBuffer::getMemorySize(width, height), std::shared_ptr<void>(surface),
+		[surface, width, height](uint8_t* storage) { surface->init(width, height, storage); });
+}
+
+//-------------------------------------------------------------------------------------
+RenderGraph::ResourceHandle RenderGraph::createGBuffer(const char* name, int32_t width, int32_t height)
+{
+	GBuffer* surface = new GBuffer();
+	return _addSurface(name, ST_GBUFFER, width, height, GBuffer::getMemorySize(width, height), std::shared_ptr<void>(surface),
+		[surface, width, height](uint8_t* storage) { surface->init(width, height, storage); });
+}
+
+//-------------------------------------------------------------------------------------
+RenderGraph::ResourceHandle RenderGraph::createRenderTargetSet(const char* name, int32_t width, int32_t height, const std::vector<PixelFormat>& formats)
+{
+	RenderTargetSet* surface = new RenderTargetSet();
+	return _addSurface(name, ST_RENDER_TARGET_SET, width, height, RenderTargetSet::getMemorySize(width, height, formats), std::shared_ptr<void>(surface),
+		[surface, width, height, formats](uint8_t* storage) { surface->init(width, height, formats, storage); });
+}
+
+//-------------------------------------------------------------------------------------
+RenderGraph::ResourceHandle RenderGraph::importResource(const char* name)
+{
+	Resource resource;
+	resource.name = name;
+	resource.imported = true;
+	resource.type = ST_PIXELS;
+	resource.desc.width = resource.desc.height = 0;
+	resource.desc.format = PF_FLOAT32_RGBA;
+	resource.size = 0;
+	resource.firstLevel = resource.lastLevel = -1;
+	resource.block = -1;
+
+	m_resources.push_back(resource);
+	return (ResourceHandle)(m_resources.size() - 1);
+}
+
+//-------------------------------------------------------------------------------------
+void RenderGraph::addPass(const char* name, std::initializer_list<ResourceHandle> inputs, std::initializer_list<ResourceHandle> outputs, ExecuteFunction func)
+{
+	Pass pass;
+	pass.name = name;
+	pass.inputs = inputs;
+	pass.outputs = outputs;
+	pass.func = func;
+	pass.level = -1;
+
+	m_passes.push_back(pass);
+}
+
+//-------------------------------------------------------------------------------------
+void RenderGraph::reset(void)
+{
+	m_resources.clear();
+	m_passes.clear();
+	m_levels.clear();
+}
+
+//-------------------------------------------------------------------------------------
+void RenderGraph::compile(void)
+{
+	_cullPasses();
+	_buildLevels();
+	_assignMemory();
+}
+
+//-------------------------------------------------------------------------------------
+void RenderGraph::_cullPasses(void)
+{
+	//walk backward from the passes which write imported resources(or have no output), 
+	//a pass is alive if a later alive pass reads what it writes
+	std::vector<bool> needed(m_resources.size(), false);
+
+	for (size_t i = m_passes.size(); i-- > 0; ) {
+		Pass& pass = m_passes[i];
+
+		bool alive = pass.outputs.empty();
+		for (ResourceHandle output : pass.outputs) {
+			if (m_resources[(size_t)output].imported || needed[(size_t)output]) {
+				alive = true;
+			}
+		}
+		pass.level = alive ? 0 : -1;
+		if (!alive) continue;
+
+		//content written here replaces the old one, earlier writers are not needed for it
+		for (ResourceHandle output : pass.outputs) {
+			needed[(size_t)output] = false;
+		}
+		for (ResourceHandle input : pass.inputs) {
+			needed[(size_t)input] = true;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void RenderGraph::_buildLevels(void)
+{
+	//level of a pass is one after all passes it depends on:
+	//read after write, write after write and write after read of the same resource
+	std::vector<int32_t> lastWriteLevel(m_resources.size(), -1);
+	std::vector<int32_t> lastReadLevel(m_resources.size(), -1);
+
+	m_levels.clear();
+	for (size_t i = 0; i < m_passes.size(); i++) {
+		Pass& pass = m_passes[i];
+		if (pass.level < 0) continue;
+
+		int32_t level = 0;
+		for (ResourceHandle input : pass.inputs) {
+			level = MathUtil::max2(level, lastWriteLevel[(size_t)input] + 1);
+		}
+		for (ResourceHandle output : pass.outputs) {
+			level = MathUtil::max2(level, MathUtil::max2(lastWriteLevel[(size_t)output], lastReadLevel[(size_t)output]) + 1);
+		}
+		pass.level = level;
+
+		for (ResourceHandle input : pass.inputs) {
+			lastReadLevel[(size_t)input] = MathUtil::max2(lastReadLevel[(size_t)input], level);
+		}
+		for (ResourceHandle output : pass.outputs) {
+			lastWriteLevel[(size_t)output] = level;
+		}
+
+		if ((size_t)level >= m_levels.size()) m_levels.resize((size_t)level + 1);
+		m_levels[(size_t)level].push_back(i);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void RenderGraph::_assignMemory(void)
+{
+	//lifetime of transient surfaces in levels
+	for (Resource& resource : m_resources) {
+		resource.firstLevel = resource.lastLevel = -1;
+		resource.block = -1;
+	}
+	for (const Pass& pass : m_passes) {
+		if (pass.level < 0) continue;
+
+		auto touch = [this, &pass](ResourceHandle handle) {
+			Resource& resource = m_resources[(size_t)handle];
+			resource.firstLevel = (resource.firstLevel < 0) ? pass.level : MathUtil::min2(resource.firstLevel, pass.level);
+			resource.lastLevel = MathUtil::max2(resource.lastLevel, pass.level);
+		};
+		for (ResourceHandle input : pass.inputs) touch(input);
+		for (ResourceHandle output : pass.outputs) touch(output);
+	}
+
+	std::vector<size_t> order;
+	for (size_t i = 0; i < m_resources.size(); i++) {
+		if (!m_resources[i].imported && m_resources[i].firstLevel >= 0) order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+		return m_resources[a].firstLevel < m_resources[b].firstLevel;
+	});
+
+	//greedy aliasing, a block is free when its owner dies before the surface is born.
+	//take the smallest free block which is large enough, otherwise grow the largest free one
+	for (Block& block : m_blocks) {
+		block.lastLevel = -1;
+	}
+	for (size_t index : order) {
+		Resource& resource = m_resources[index];
+		size_t size = resource.size;
+
+		int32_t fit = -1, largest = -1;
+		for (size_t i = 0; i < m_blocks.size(); i++) {
+			const Block& block = m_blocks[i];
+			if (block.lastLevel >= resource.firstLevel) continue;
+
+			if (block.memory.size() >= size && (fit < 0 || block.memory.size() < m_blocks[(size_t)fit].memory.size())) {
+				fit = (int32_t)i;
+			}
+			if (largest < 0 || block.memory.size() > m_blocks[(size_t)largest].memory.size()) {
+				largest = (int32_t)i;
+			}
+		}
+
+		if (fit < 0) {
+			if (largest < 0) {
+				m_blocks.push_back(Block());
+				largest = (int32_t)(m_blocks.size() - 1);
+			}
+			fit = largest;
+			m_blocks[(size_t)fit].memory.resize(size);
+		}
+
+		m_blocks[(size_t)fit].lastLevel = resource.lastLevel;
+		resource.block = fit;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void RenderGraph::execute(void)
+{
+	for (size_t i = 0; i < m_levels.size(); i++) {
+		//surfaces born in this level take over their memory, the previous owners are dead
+		for (Resource& resource : m_resources) {
+			if (!resource.imported && resource.firstLevel == (int32_t)i) {
+				resource.init(&(m_blocks[(size_t)resource.block].memory[0]));
+			}
+		}
+
+		//one pass at a time, see the class comment
+		for (size_t index : m_levels[i]) {
+			m_passes[index].func(*this);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+size_t RenderGraph::getTransientMemorySize(void) const
+{
+	size_t size = 0;
+	for (const Block& block : m_blocks) {
+		size += block.memory.size();
+	}
+	return size;
+}
+
+//-------------------------------------------------------------------------------------
+size_t RenderGraph::getRequestedMemorySize(void) const
+{
+	size_t size = 0;
+	for (const Resource& resource : m_resources) {
+		if (!resource.imported && resource.firstLevel >= 0) size += resource.size;
+	}
+	return size;
+}
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+#include "device/dv_pixel_buffer.h"
+
+namespace davinci
+{
+
+//Passes of one frame declare the resources they read and write, the graph orders them into levels
+//(passes of one level don't depend on each other), culls passes whose outputs are never used, 
+//and lets transient surfaces whose lifetimes don't overlap share the same memory.
+//Passes are never run concurrently, render queue and pipe stages keep per-frame state(camera, 
+//constants, statistics, scratch buffers) and are not reentrant. A pass may go wide internally.
+class RenderGraph : noncopyable
+{
+public:
+	typedef int32_t ResourceHandle;
+	enum { INVALID_HANDLE = -1 };
+
+	struct SurfaceDesc
+	{
+		int32_t width;
+		int32_t height;
+		PixelFormat format;
+	};
+
+	typedef std::function<void(const RenderGraph& graph)> ExecuteFunction;
+
+	//transient surfaces, memory is owned by graph and shared by surfaces whose lifetimes don't overlap.
+	//a surface is initialized(cleared as the init of its type) right before its first pass
+	ResourceHandle createSurface(const char* name, const SurfaceDesc& desc);
+	ResourceHandle createRenderTarget(const char* name, int32_t width, int32_t height);
+	ResourceHandle createDepthBuffer(const char* name, int32_t width, int32_t height);
+	ResourceHandle createGBuffer(const char* name, int32_t width, int32_t height);
+	ResourceHandle createRenderTargetSet(const char* name, int32_t width, int32_t height, const std::vector<PixelFormat>& formats);
+	//resource owned outside of graph(eg. final render target, shadow map), only used to order passes, 
+	//passes which write it are never culled
+	ResourceHandle importResource(const char* name);
+	//pass reads inputs and writes outputs, passes are called in declaration order unless they are independent
+	void addPass(const char* name, std::initializer_list<ResourceHandle> inputs, std::initializer_list<ResourceHandle> outputs, ExecuteFunction func);
+
+	//cull, order passes and assign memory of transient surfaces
+	void compile(void);
+	//run all levels in order, passes of one level in declaration order
+	void execute(void);
+	//remove all passes and resources, memory is kept for next frame
+	void reset(void);
+
+	//transient surfaces, valid during execute. 
+	//T of a pixel surface is the pixel type of its format(fVector4 for PF_FLOAT32_RGBA, float for PF_FLOAT32_R, ...)
+	template<typename T>
+	PixelBuffer<T>& getPixelBuffer(ResourceHandle handle) const {
+		assert(sizeof(T) == _getPixelSize(m_resources[(size_t)handle].desc.format));
+		return *(PixelBuffer<T>*)_getSurface(handle, ST_PIXELS);
+	}
+	template<typename T>
+	T* getSurface(ResourceHandle handle) const {
+		return getPixelBuffer<T>(handle).ptr();
+	}
+	RenderTarget& getRenderTarget(ResourceHandle handle) const { return *(RenderTarget*)_getSurface(handle, ST_RENDER_TARGET); }
+	DepthBuffer& getDepthBuffer(ResourceHandle handle) const { return *(DepthBuffer*)_getSurface(handle, ST_DEPTH_BUFFER); }
+	GBuffer& getGBuffer(ResourceHandle handle) const { return *(GBuffer*)_getSurface(handle, ST_GBUFFER); }
+	RenderTargetSet& getRenderTargetSet(ResourceHandle handle) const { return *(RenderTargetSet*)_getSurface(handle, ST_RENDER_TARGET_SET); }
+
+	const SurfaceDesc& getSurfaceDesc(ResourceHandle handle) const {
+		return m_resources[(size_t)handle].desc;
+	}
+
+	//results of compile
+	size_t getLevelCounts(void) const { return m_levels.size(); }
+	//-1 if the pass is culled
+	int32_t getPassLevel(size_t passIndex) const { return m_passes[passIndex].level; }
+	//memory of all transient surfaces, with and without aliasing
+	size_t getTransientMemorySize(void) const;
+	size_t getRequestedMemorySize(void) const;
+
+private:
+	enum SurfaceType
+	{
+		ST_PIXELS,
+		ST_RENDER_TARGET,
+		ST_DEPTH_BUFFER,
+		ST_GBUFFER,
+		ST_RENDER_TARGET_SET,
+	};
+
+	//attach surface object to its memory and clear it
+	typedef std::function<void(uint8_t* storage)> InitFunction;
+
+	struct Resource
+	{
+		std::string name;
+		bool imported;
+		SurfaceType type;
+		SurfaceDesc desc;
+		size_t size;		//bytes of memory
+		std::shared_ptr<void> surface;
+		InitFunction init;
+		int32_t firstLevel;
+		int32_t lastLevel;
+		int32_t block;		//index of memory block
+	};
+
+	struct Pass
+	{
+		std::string name;
+		std::vector<ResourceHandle> inputs;
+		std::vector<ResourceHandle> outputs;
+		ExecuteFunction func;
+		int32_t level;
+	};
+
+	struct Block
+	{
+		std::vector<uint8_t> memory;
+		int32_t lastLevel;	//last level of current owner
+	};
+
+	static size_t _getPixelSize(PixelFormat format);
+	ResourceHandle _addSurface(const char* name, SurfaceType type, int32_t width, int32_t height, size_t size, std::shared_ptr<void> surface, InitFunction init);
+	template<typename T>
+	ResourceHandle _addPixelSurface(const char* name, const SurfaceDesc& desc);
+	void* _getSurface(ResourceHandle handle, SurfaceType type) const {
+		const Resource& resource = m_resources[(size_t)handle];
+		assert(!resource.imported && resource.type == type && resource.block >= 0);
+		return resource.surface.get();
+	}
+	void _cullPasses(void);
+	void _buildLevels(void);
+	void _assignMemory(void);
+
+private:
+	std::vector<Resource> m_resources;
+	std::vector<Pass> m_passes;
+	std::vector<std::vector<size_t>> m_levels;
+	std::vector<Block> m_blocks;
+
+public:
+	RenderGraph() {}
+	~RenderGraph() {}
+};
+
+}
@@ -2,32 +2,82 @@
 #include "dv_render_queue.h"
 
 #include "device/dv_constant_buffer.h"
+#include "device/dv_render_target.h"
+#include "device/dv_gbuffer.h"
+#include "device/dv_render_target_set.h"
+#include "device/dv_visibility_buffer.h"
 
+#include "dv_renderable.h"
+#include "dv_command_list.h"
 #include "dv_pipe_IA.h"
 #include "dv_pipe_VS.h"
+#include "dv_pipe_PA.h"
 #include "dv_pipe_PS.h"
+#include "dv_pipe_visibility.h"
+#include "dv_pipe_depth.h"
 
 namespace davinci
 {
 
+//-------------------------------------------------------------------------------------
+RenderQueue::RenderQueue()
+	: m_device(nullptr)
+	, m_streamChunkSize(DEFAULT_STREAM_CHUNK_SIZE)
+	, m_sortEnabled(true)
+{
+}
+
+//-------------------------------------------------------------------------------------
+RenderQueue::~RenderQueue()
+{
+	clear();
+}
+
 //-------------------------------------------------------------------------------------
 void RenderQueue::clear(void)
 {
+	//renderables are detached, so their owners push them again at next render
+	for (RenderablePtr renderable : m_queue) {
+		renderable->m_queue = nullptr;
+	}
 	m_queue.clear();
+	m_submitted.clear();
 }
 
 //-------------------------------------------------------------------------------------
 void RenderQueue::setCamera(const Camera& camera)
 {
 	m_camera = camera;
+
+	m_viewConstants.matViewProj = m_camera.getViewProjMatrix();
+	m_viewConstants.eyePos = m_camera.getEye();
 }
 
 //-------------------------------------------------------------------------------------
 void RenderQueue::pushRenderable(RenderablePtr renderable)
 {
+	assert(renderable->m_queue == nullptr);
+
+	renderable->m_queue = this;
+	renderable->m_queueSlot = m_queue.size();
 	m_queue.push_back(renderable);
 }
 
+//-------------------------------------------------------------------------------------
+void RenderQueue::removeRenderable(ConstRenderablePtr renderable)
+{
+	if (renderable->m_queue != this) return;
+
+	//swap with the last one, order of queue is rebuilt by _sort anyway
+	size_t slot = renderable->m_queueSlot;
+	assert(m_queue[slot] == renderable);
+	m_queue[slot]->m_queue = nullptr;
+
+	m_queue[slot] = m_queue.back();
+	m_queue[slot]->m_queueSlot = slot;
+	m_queue.pop_back();
+}
+
 //-------------------------------------------------------------------------------------
 void RenderQueue::visitorRenderable(std::function<void(ConstRenderablePtr renderable)> visitorFunc) const
 {
@@ -36,33 +86,304 @@ void RenderQueue::visitorRenderable(std::function<void(ConstRenderablePtr render
 	}
 }
 
+//-------------------------------------------------------------------------------------
+void RenderQueue::submit(const CommandList& commandList)
+{
+	const uint8_t* viewConstants = (const uint8_t*)&m_viewConstants;
+
+	for (size_t i = 0; i < commandList.getDrawCounts(); i++) {
+		RenderablePtr draw = commandList.getDraw(i);
+		draw->bindVSConstantBuffer(ConstantBuffer::VIEW_CONSTANT_SLOT, viewConstants);
+		draw->bindPSConstantBuffer(ConstantBuffer::VIEW_CONSTANT_SLOT, viewConstants);
+
+		pushRenderable(draw);
+		m_submitted.push_back(draw);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void RenderQueue::clearSubmitted(void)
+{
+	for (ConstRenderablePtr draw : m_submitted) {
+		removeRenderable(draw);
+	}
+	m_submitted.clear();
+}
+
+//-------------------------------------------------------------------------------------
+typedef std::pair<uint64_t, RenderablePtr> SortItem;
+
+//LSD radix sort by key, 8 bits per pass, the order of same keys is kept
+static void _radixSort(std::vector<SortItem>& items)
+{
+	std::vector<SortItem> temp(items.size());
+
+	for (uint32_t shift = 0; shift < 64; shift += 8) {
+		size_t offset[256] = { 0 };
+		for (const SortItem& item : items) {
+			offset[(item.first >> shift) & 0xFF]++;
+		}
+		//all keys have the same byte
+		if (offset[(items[0].first >> shift) & 0xFF] == items.size()) continue;
+
+		size_t total = 0;
+		for (size_t i = 0; i < 256; i++) {
+			size_t counts = offset[i];
+			offset[i] = total;
+			total += counts;
+		}
+		for (SortItem& item : items) {
+			temp[offset[(item.first >> shift) & 0xFF]++] = std::move(item);
+		}
+		items.swap(temp);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void RenderQueue::_sort(void)
+{
+	if (!m_sortEnabled || m_queue.size() < 2) return;
+
+	/*
+		sort key(64bits)
+		opaque  : | 0 | shader pair(15) | view depth(32)  | constant buffer(16) |
+		blended : | 1 | ~view depth(32) | shader pair(15) | constant buffer(16) |
+
+		renderables with the same VS/PS are grouped together, and drawn front-to-back in each group to 
+		maximise early depth rejection. ids of shader pair and constant buffer are given by the order of
+		first appearance, so the result is stable between frames.
+		blended renderables are drawn after all opaque ones, back-to-front, so they are composited in 
+		the right order. opaque ones without depth write(e.g. CF_EQUAL after a Z-prepass) stay in groups.
+	*/
+	typedef std::pair<const void*, const void*> IdentityPair;
+	std::map<IdentityPair, uint64_t> shaderID, constantBufferID;
+
+	const fVector3& eye = m_camera.getEye();
+	fVector3 forward = m_camera.getLookat() - eye;
+	forward.normalise();
+
+	std::vector<SortItem> items;
+	items.reserve(m_queue.size());
+
+	for (RenderablePtr renderable : m_queue) {
+		uint64_t shader = shaderID.insert(std::make_pair(IdentityPair(renderable->getVS().get(), renderable->getPS().get()), shaderID.size())).first->second;
+		uint64_t constantBuffer = constantBufferID.insert(std::make_pair(IdentityPair(renderable->getVSConstantBuffer().get(), renderable->getPSConstantBuffer().get()), constantBufferID.size())).first->second;
+
+		//origin of renderable in view space, the bit pattern of a positive float has the same order as its value
+		const fMatrix4& transform = renderable->getWorldTransform();
+		float viewDepth = MathUtil::max2(0.f, (fVector3(transform[3][0], transform[3][1], transform[3][2]) - eye).dotProduct(forward));
+		uint32_t depth;
+		memcpy(&depth, &viewDepth, sizeof(depth));
+
+		uint64_t key;
+		if (renderable->getBlendState().blendEnable) {
+			key = (1ull << 63) | ((uint64_t)(~depth) << 31) | ((shader & 0x7FFF) << 16) | (constantBuffer & 0xFFFF);
+		}
+		else {
+			key = ((shader & 0x7FFF) << 48) | ((uint64_t)depth << 16) | (constantBuffer & 0xFFFF);
+		}
+		items.push_back(SortItem(key, renderable));
+	}
+
+	_radixSort(items);
+
+	for (size_t i = 0; i < items.size(); i++) {
+		m_queue[i] = items[i].second;
+		m_queue[i]->m_queueSlot = i;
+	}
+}
+
 //-------------------------------------------------------------------------------------
 void RenderQueue::process(RenderTarget& renderTarget)
+{
+	_processGeometry(renderTarget.getWidth(), renderTarget.getHeight(), true, [&renderTarget](const PrimitiveAfterVS::Node& node) {
+		PixelShader::processNode(node, renderTarget);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void RenderQueue::processGBuffer(GBuffer& gbuffer)
+{
+	_processGeometry(gbuffer.getWidth(), gbuffer.getHeight(), true, [&gbuffer](const PrimitiveAfterVS::Node& node) {
+		PixelShader::processGBufferNode(node, gbuffer);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void RenderQueue::processMultiTarget(RenderTargetSet& renderTargetSet)
+{
+	_processGeometry(renderTargetSet.getWidth(), renderTargetSet.getHeight(), true, [&renderTargetSet](const PrimitiveAfterVS::Node& node) {
+		PixelShader::processMultiTargetNode(node, renderTargetSet);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void RenderQueue::processDepth(DepthBuffer& depthBuffer)
+{
+	_processGeometry(depthBuffer.getWidth(), depthBuffer.getHeight(), false, [&depthBuffer](const PrimitiveAfterVS::Node& node) {
+		DepthOnly::processNode(node, DepthOnly::DM_PLANE, depthBuffer);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void RenderQueue::processZPrepass(RenderTarget& renderTarget)
+{
+	DepthBuffer& depthBuffer = renderTarget.getDepthBuffer();
+
+	_processGeometry(depthBuffer.getWidth(), depthBuffer.getHeight(), false, [&depthBuffer](const PrimitiveAfterVS::Node& node) {
+		//opaque draws which write depth, or test against the prepass with CF_EQUAL
+		const DepthStencilState& state = node.depthStencilState;
+		if (node.blendState.blendEnable || !state.depthEnable || (!state.depthWrite && state.depthFunc != CF_EQUAL)) return;
+
+		DepthOnly::processNode(node, DepthOnly::DM_INTERPOLATED, depthBuffer);
+	});
+}
+
+//-------------------------------------------------------------------------------------
+void RenderQueue::_processGeometry(int32_t targetWidth, int32_t targetHeight, bool attributePhase, PixelStageFunction pixelStage)
+{
+	m_cullStatistics.reset();
+	_sort();
+
+	if (m_streamChunkSize > 0) {
+		_processStream(targetWidth, targetHeight, attributePhase, pixelStage);
+	}
+	else {
+		_processWholeFrame(targetWidth, targetHeight, attributePhase, pixelStage);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void RenderQueue::_processVertices(int32_t targetWidth, int32_t targetHeight, bool attributePhase, PrimitiveAfterVS& output)
 {
 	//0 : Input Assember
 	/*
 		Renderable Queue -> IA  -> PrimitiveAfterAssember
 	*/
 	PrimitiveAfterAssember inputPrimitive;
-	InputAssember::process(*this, inputPrimitive);
+	InputAssember::process(*this, attributePhase, inputPrimitive);
 
 
 
-	//1 : Vertex Shader
+	//1 : Vertex Shader(position phase)
 	/*
 		PrimitiveAfterAssember -> VS -> PrimitiveAfterVS
 	*/
-	PrimitiveAfterVS primitiveAfterVS;
-	VertexShader::process(getDevice(), inputPrimitive, primitiveAfterVS);
+	VertexShader::process(getDevice(), inputPrimitive, output);
+
+
 
+	//2 : Primitive Assembler
+	/*
+		PrimitiveAfterVS -> PA(cull) -> PrimitiveAfterVS(visible primitives)
+	*/
+	PrimitiveAssembler::process(targetWidth, targetHeight, output, m_cullStatistics);
+
+
+
+	//3 : Vertex Shader(attribute phase)
+	/*
+		PrimitiveAfterVS(visible primitives) -> VS -> PrimitiveAfterVS
+	*/
+	if (attributePhase) {
+		VertexShader::processAttribute(output);
+	}
+}
 
+//-------------------------------------------------------------------------------------
+void RenderQueue::_processWholeFrame(int32_t targetWidth, int32_t targetHeight, bool attributePhase, PixelStageFunction pixelStage)
+{
+	PrimitiveAfterVS primitiveAfterVS;
+	_processVertices(targetWidth, targetHeight, attributePhase, primitiveAfterVS);
 
-	//2: Pixel Shader
+	//4: Pixel Shader
 	/*
-		PrimitiveAfterVS -> PS -> Render Target Texture
+		PrimitiveAfterVS -> PS -> Render Target Texture(or G-buffer)
 	*/
-	PixelShader::process(primitiveAfterVS, renderTarget);
+	static_cast<const PrimitiveAfterVS&>(primitiveAfterVS).visitor(pixelStage);
 }
 
+//-------------------------------------------------------------------------------------
+void RenderQueue::processVisibility(VisibilityBuffer& visibilityBuffer, RenderTarget& renderTarget)
+{
+	assert(visibilityBuffer.getWidth() == renderTarget.getWidth() && visibilityBuffer.getHeight() == renderTarget.getHeight());
+	m_cullStatistics.reset();
+	_sort();
+
+	PrimitiveAfterVS primitiveAfterVS;
+	_processVertices(renderTarget.getWidth(), renderTarget.getHeight(), true, primitiveAfterVS);
+
+	//draw id has only 12 bits(instances are nodes too), nodes beyond it go to next batch.
+	//each batch is resolved into render target, which depth tests it against the batches before
+	for (size_t first = 0; first < primitiveAfterVS.getNodeCounts(); first += VisibilityBuffer::MAX_DRAW_COUNTS) {
+		size_t last = MathUtil::min2(first + VisibilityBuffer::MAX_DRAW_COUNTS, primitiveAfterVS.getNodeCounts());
+		if (first > 0) visibilityBuffer.clear();
+
+		//4: Raster pass
+		/*
+			PrimitiveAfterVS -> Rasterizer -> VisibilityBuffer
+		*/
+		for (size_t i = first; i < last; i++) {
+			const PrimitiveAfterVS::Node& node = primitiveAfterVS.getNode(i);
+			if (PixelShader::needsBlendUnit(node) || !node.depthStencilState.isDefault()) continue;
+
+			uint32_t drawID = (uint32_t)(i - first);
+			assert(drawID < VisibilityBuffer::MAX_DRAW_COUNTS);
+			VisibilityShading::processNode(drawID, node, visibilityBuffer);
+		}
+
+		//5: Resolve pass
+		/*
+			VisibilityBuffer + PrimitiveAfterVS -> PS -> Render Target Texture
+		*/
+		VisibilityShading::resolve(primitiveAfterVS, first, visibilityBuffer, renderTarget);
+	}
+
+	for (size_t i = 0; i < primitiveAfterVS.getNodeCounts(); i++) {
+		//blended nodes, and nodes with their own depth test, are drawn over the resolved image in order
+		const PrimitiveAfterVS::Node& node = primitiveAfterVS.getNode(i);
+		if (!isTrianglePrimitive(node.primitiveType) || PixelShader::needsBlendUnit(node) || !node.depthStencilState.isDefault()) {
+			PixelShader::processNode(node, renderTarget);
+		}
+	}
 }
 
+//-------------------------------------------------------------------------------------
+void RenderQueue::_processStream(int32_t targetWidth, int32_t targetHeight, bool attributePhase, PixelStageFunction pixelStage)
+{
+	/*
+		Renderable -> [chunk] -> IA -> [instance] -> VS(position) -> PA -> VS(attribute) -> PS -> Render Target Texture(or G-buffer)
+	*/
+
+	//the nodes are reused by all chunks, so the memory footprint is bounded by the chunk size
+	PrimitiveAfterAssember::Node inputNode;
+	PrimitiveAfterVS::Node vsNode;
+
+	for (ConstRenderablePtr renderable : m_queue) {
+		size_t primitiveCounts = InputAssember::primitiveCounts(renderable);
+		size_t instanceCounts = renderable->getInstanceCounts();
+		uint32_t stripParity = 0;
+
+		for (size_t first = 0; first < primitiveCounts; first += m_streamChunkSize) {
+			size_t chunkCounts = MathUtil::min2(m_streamChunkSize, primitiveCounts - first);
+
+			if (!InputAssember::processChunk(getDevice(), renderable, first, chunkCounts, stripParity, attributePhase, inputNode)) break;
+			stripParity = inputNode.nextStripParity;
+
+			//restart indices only, the strip goes on in next chunk
+			if (inputNode.vertexCounts == 0) continue;
+
+			//the chunk is assembled once for all instances
+			for (size_t instance = 0; instance < instanceCounts; instance++) {
+				VertexShader::processNode(getDevice(), inputNode, (uint32_t)instance, vsNode);
+				PrimitiveAssembler::processNode(targetWidth, targetHeight, vsNode, m_cullStatistics);
+				if (attributePhase) {
+					VertexShader::processAttributeNode(vsNode);
+				}
+				pixelStage(vsNode);
+			}
+		}
+	}
+}
+
+}
@@ -4,6 +4,8 @@
 
 //to be remove
 #include "scene/dv_camera.h"
+#include "device/dv_constant_buffer.h"
+#include "dv_pipe_PA.h"
 
 namespace davinci
 {
@@ -11,12 +13,19 @@ namespace davinci
 class RenderQueue
 {
 public:
+	enum { DEFAULT_STREAM_CHUNK_SIZE = 1024 };
+
+	//drop all renderables, they are detached(see Renderable::getQueue) so entities add them again at next render
 	void clear(void);
 	
 	void setCamera(const Camera& camera);
 	const Camera& getCamera(void) const {
 		return m_camera; 
 	}
+	//per-view constants of current camera, address is stable during the life of queue
+	const ViewConstants& getViewConstants(void) const {
+		return m_viewConstants;
+	}
 
 	void setDevice(const RenderDevice* device) {
 		m_device = device;
@@ -25,15 +34,81 @@ public:
 		return m_device;
 	}
 
+	//renderables are retained until removed or the queue is cleared, a renderable can be in one queue only.
+	//removal is O(1) and doesn't keep the order of the others
 	void pushRenderable(RenderablePtr renderable);
+	void removeRenderable(ConstRenderablePtr renderable);
 	void visitorRenderable(std::function<void(ConstRenderablePtr renderable)> visitorFunc) const;
 
+	//add draws of a command list after the renderables, lists recorded on other threads must be finished.
+	//submitted draws are rendered until clearSubmitted
+	void submit(const CommandList& commandList);
+	//remove all submitted draws, call before the lists are reset and recorded again
+	void clearSubmitted(void);
+
+	//primitive counts of each chunk which pushed through IA->VS->PS in streaming mode,
+	//0 means materialise the whole frame between stages
+	void setStreamChunkSize(size_t primitiveCounts) {
+		m_streamChunkSize = primitiveCounts;
+	}
+	size_t getStreamChunkSize(void) const {
+		return m_streamChunkSize;
+	}
+
+	//sort renderables before IA by state and view depth, see the key layout in _sort
+	void setSortEnabled(bool sortEnabled) {
+		m_sortEnabled = sortEnabled;
+	}
+	bool isSortEnabled(void) const {
+		return m_sortEnabled;
+	}
+
 	void process(RenderTarget& renderTarget);
+	//geometry pass of deferred shading, use LightingShader::process to shade the G-buffer
+	void processGBuffer(GBuffer& gbuffer);
+	//shade once into all targets of the set(PixelShader::psMultiTarget), opaque with default depth test only
+	void processMultiTarget(RenderTargetSet& renderTargetSet);
+	//visibility buffer rendering, the whole frame is always materialised because resolve pass needs all nodes.
+	//points and lines are not in visibility buffer, they are shaded forward after resolve.
+	//nodes beyond VisibilityBuffer::MAX_DRAW_COUNTS are rasterized and resolved in more batches
+	void processVisibility(VisibilityBuffer& visibilityBuffer, RenderTarget& renderTarget);
+	//depth-only rendering(eg. shadow map with a light camera), no pixel shader and no attribute phase, 
+	//depth is from plane equation of triangles
+	void processDepth(DepthBuffer& depthBuffer);
+	//Z-prepass, fill depth of render target the same way as pixel shaders, 
+	//then call process() with DepthStencilState::makeDepthEqual() on the renderables to shade each pixel once
+	void processZPrepass(RenderTarget& renderTarget);
+
+	//primitive cull counters of last process
+	const CullStatistics& getCullStatistics(void) const {
+		return m_cullStatistics;
+	}
+
+private:
+	void _sort(void);
+
+	//last stage of pipeline, consume the visible primitives of a node
+	typedef std::function<void(const PrimitiveAfterVS::Node& node)> PixelStageFunction;
+
+	//attribute phase of VS is skipped for depth-only rendering
+	void _processGeometry(int32_t targetWidth, int32_t targetHeight, bool attributePhase, PixelStageFunction pixelStage);
+	void _processVertices(int32_t targetWidth, int32_t targetHeight, bool attributePhase, PrimitiveAfterVS& output);
+	void _processWholeFrame(int32_t targetWidth, int32_t targetHeight, bool attributePhase, PixelStageFunction pixelStage);
+	void _processStream(int32_t targetWidth, int32_t targetHeight, bool attributePhase, PixelStageFunction pixelStage);
 
 protected:
-	std::vector<ConstRenderablePtr> m_queue;
+	std::vector<RenderablePtr> m_queue;
+	std::vector<ConstRenderablePtr> m_submitted;
 	const RenderDevice* m_device;
 	Camera m_camera;
+	ViewConstants m_viewConstants;
+	size_t m_streamChunkSize;
+	bool m_sortEnabled;
+	CullStatistics m_cullStatistics;
+
+public:
+	RenderQueue();
+	~RenderQueue();
 };
 
 }
@@ -18,4 +18,16 @@ void Renderable::setPSConstantBuffer(int32_t index, const uint8_t* buffer, size_
 	m_psConstantBuffer->setBuffer(index, buffer, length);
 }
 
+//-------------------------------------------------------------------------------------
+void Renderable::bindVSConstantBuffer(int32_t index, const uint8_t* buffer)
+{
+	m_vsConstantBuffer->bindBuffer(index, buffer);
+}
+
+//-------------------------------------------------------------------------------------
+void Renderable::bindPSConstantBuffer(int32_t index, const uint8_t* buffer)
+{
+	m_psConstantBuffer->bindBuffer(index, buffer);
+}
+
 }
@@ -2,13 +2,21 @@
 
 #include "dv_prerequisites.h"
 
+//to be remove
+#include "device/dv_blend_state.h"
+#include "device/dv_depth_stencil_state.h"
+#include "device/dv_instance_buffer.h"
+
 namespace davinci
 {
 
 class Renderable
 {
 public:
-	virtual ConstVertexBufferPtr getVertexBuffer(void) const = 0;
+	//vertex data can be split into several streams(eg. position, normal/tangent, uv), 
+	//IA only fetches the streams which have elements needed by vertex shader
+	virtual size_t getVertexStreamCounts(void) const = 0;
+	virtual ConstVertexBufferPtr getVertexStream(size_t index) const = 0;
 	virtual ConstIndexBufferPtr getIndexBuffer(void) const = 0;
 
 	virtual PrimitiveType getPrimitiveType(void) const {
@@ -27,8 +35,53 @@ public:
 		return m_ps;
 	}
 
+	void setCullMode(CullMode cullMode) {
+		m_cullMode = cullMode;
+	}
+	CullMode getCullMode(void) const {
+		return m_cullMode;
+	}
+
+	//variable-rate shading of this draw
+	void setShadingRate(ShadingRate shadingRate) {
+		m_shadingRate = shadingRate;
+	}
+	ShadingRate getShadingRate(void) const {
+		return m_shadingRate;
+	}
+
+	//blended renderables are drawn after opaque ones, back-to-front
+	void setBlendState(const BlendState& blendState) {
+		m_blendState = blendState;
+	}
+	const BlendState& getBlendState(void) const {
+		return m_blendState;
+	}
+
+	//transparent renderables usually test depth without writing it, stencil marks regions for other draws
+	void setDepthStencilState(const DepthStencilState& depthStencilState) {
+		m_depthStencilState = depthStencilState;
+	}
+	const DepthStencilState& getDepthStencilState(void) const {
+		return m_depthStencilState;
+	}
+
+	//draw once per instance, vertices are assembled once for all instances.
+	//data of each instance is bound to ConstantBuffer::INSTANCE_CONSTANT_SLOT of vertex shader
+	void setInstanceBuffer(ConstInstanceBufferPtr instanceBuffer) {
+		m_instanceBuffer = instanceBuffer;
+	}
+	ConstInstanceBufferPtr getInstanceBuffer(void) const {
+		return m_instanceBuffer;
+	}
+	size_t getInstanceCounts(void) const {
+		return m_instanceBuffer ? m_instanceBuffer->counts() : 1;
+	}
+
 	void setVSConstantBuffer(int32_t index, const uint8_t* buffer, size_t length);
 	void setPSConstantBuffer(int32_t index, const uint8_t* buffer, size_t length);
+	void bindVSConstantBuffer(int32_t index, const uint8_t* buffer);
+	void bindPSConstantBuffer(int32_t index, const uint8_t* buffer);
 
 	ConstConstantBufferPtr getVSConstantBuffer(void) const {
 		return m_vsConstantBuffer;
@@ -37,6 +90,11 @@ public:
 		return m_psConstantBuffer;
 	}
 
+	//the queue this renderable is in, null if not pushed or the queue was cleared
+	RenderQueue* getQueue(void) const {
+		return m_queue;
+	}
+
 protected:
 	PrimitiveType m_primitiveType;
 	fMatrix4 m_worldTransform;
@@ -44,6 +102,22 @@ protected:
 	ConstPixelShaderPtr m_ps;
 	ConstantBufferPtr m_vsConstantBuffer;
 	ConstantBufferPtr m_psConstantBuffer;
+	CullMode m_cullMode;
+	ShadingRate m_shadingRate;
+	BlendState m_blendState;
+	DepthStencilState m_depthStencilState;
+	ConstInstanceBufferPtr m_instanceBuffer;
+
+private:
+	//maintained by RenderQueue, slot is the index in the queue
+	friend class RenderQueue;
+	RenderQueue* m_queue;
+	size_t m_queueSlot;
+
+public:
+	Renderable() : m_cullMode(CM_CCW), m_shadingRate(SR_1X1), m_blendState(BlendState::makeOpaque()), 
+		m_depthStencilState(DepthStencilState::makeDefault()), m_queue(nullptr), m_queueSlot(0) {}
+	virtual ~Renderable() {}
 };
 
 }
@@ -48,6 +48,19 @@ public:
 	float getNear(void) const { return m_nearClip; }
 	float getFar(void) const { return m_farClip; }
 
+	//use orthographic projection(eg. directional light), fov and aspect are ignored
+	void setOrthographic(float width, float height, bool update = true) {
+		m_orthographic = true;
+		m_orthoWidth = width;
+		m_orthoHeight = height;
+		if (update) _update();
+	}
+	void setPerspective(bool update = true) {
+		m_orthographic = false;
+		if (update) _update();
+	}
+	bool isOrthographic(void) const { return m_orthographic; }
+
 	const fMatrix4& getViewProjMatrix(void) const {
 		return m_view_proj;
 	}
@@ -62,8 +75,15 @@ private:
 	float m_aspect;
 	float m_nearClip;
 	float m_farClip;
+	bool m_orthographic;
+	float m_orthoWidth;
+	float m_orthoHeight;
 
 	fMatrix4 m_view_proj;
+
+public:
+	Camera() : m_fov(MathUtil::PI_DIV4), m_aspect(1.f), m_nearClip(0.01f), m_farClip(100.f), 
+		m_orthographic(false), m_orthoWidth(1.f), m_orthoHeight(1.f) { }
 };
 
 }
\ No newline at end of file
@@ -8,8 +8,9 @@ namespace davinci
 {
 
 //-------------------------------------------------------------------------------------
-void EntityRenderable::build(const RenderDevice* device, const fMatrix4& transform, const Model::MeshPart* meshPart, VertexShaderPtr vs, PixelShaderPtr ps)
+void EntityRenderable::build(const RenderDevice* device, const fMatrix4& transform, ConstModelPtr model, const Model::MeshPart* meshPart, VertexShaderPtr vs, PixelShaderPtr ps)
 {
+	m_model = model;
 	m_meshPart = meshPart;
 
 	m_primitiveType = m_meshPart->m_primitiveType;
@@ -21,9 +22,15 @@ void EntityRenderable::build(const RenderDevice* device, const fMatrix4& transfo
 }
 
 //-------------------------------------------------------------------------------------
-ConstVertexBufferPtr EntityRenderable::getVertexBuffer(void) const
+size_t EntityRenderable::getVertexStreamCounts(void) const
+{
+	return m_meshPart->m_vertexStreams.size();
+}
+
+//-------------------------------------------------------------------------------------
+ConstVertexBufferPtr EntityRenderable::getVertexStream(size_t index) const
 {
-	return m_meshPart->m_vertexBuffer;
+	return m_meshPart->m_vertexStreams[index];
 }
 
 //-------------------------------------------------------------------------------------
@@ -32,9 +39,26 @@ ConstIndexBufferPtr EntityRenderable::getIndexBuffer(void) const
 	return m_meshPart->m_indexBuffer;
 }
 
+//-------------------------------------------------------------------------------------
+Entity::Entity()
+	: m_shadingRate(SR_1X1)
+	, m_blendState(BlendState::makeOpaque())
+	, m_depthStencilState(DepthStencilState::makeDefault())
+{
+}
+
+//-------------------------------------------------------------------------------------
+Entity::~Entity()
+{
+	detach();
+}
+
 //-------------------------------------------------------------------------------------
 void Entity::build(const fMatrix4& transform, ConstModelPtr model, VertexShaderPtr vs, PixelShaderPtr ps)
 {
+	detach();
+	m_renderables.clear();
+
 	m_transform = transform;
 	m_model = model;
 	m_vs = vs;
@@ -42,22 +66,101 @@ void Entity::build(const fMatrix4& transform, ConstModelPtr model, VertexShaderP
 }
 
 //-------------------------------------------------------------------------------------
-void Entity::render(const fMatrix4& transParent, RenderQueue& queue)
+void Entity::detach(void)
 {
-	fMatrix4 transform = m_transform * transParent;
+	//queue clears the attachment when it's cleared or destroyed, so the pointer is never dangling
+	for (RenderablePtr renderable : m_renderables) {
+		RenderQueue* queue = renderable->getQueue();
+		if (queue) queue->removeRenderable(renderable);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::setShadingRate(ShadingRate shadingRate)
+{
+	m_shadingRate = shadingRate;
 
-	//visit all submodel of this model
-	m_model->visit(transform, [&queue, this](const fMatrix4& trans, const Model::MeshPart* meshPart) {
+	for (RenderablePtr renderable : m_renderables) {
+		renderable->setShadingRate(shadingRate);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::setBlendState(const BlendState& blendState)
+{
+	m_blendState = blendState;
+
+	for (RenderablePtr renderable : m_renderables) {
+		renderable->setBlendState(blendState);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::setDepthStencilState(const DepthStencilState& depthStencilState)
+{
+	m_depthStencilState = depthStencilState;
+
+	for (RenderablePtr renderable : m_renderables) {
+		renderable->setDepthStencilState(depthStencilState);
+	}
+}
 
-		RenderablePtr entityRenderable = std::shared_ptr<Renderable>(new EntityRenderable());
-		((EntityRenderable*)entityRenderable.get())->build(queue.getDevice(), trans, meshPart, m_vs, m_ps);
+//-------------------------------------------------------------------------------------
+void Entity::setInstanceBuffer(ConstInstanceBufferPtr instanceBuffer)
+{
+	m_instanceBuffer = instanceBuffer;
+
+	for (RenderablePtr renderable : m_renderables) {
+		renderable->setInstanceBuffer(instanceBuffer);
+	}
+}
 
-		//prepare shader
-		m_vs->preRender(trans, entityRenderable);
-		m_ps->preRender(entityRenderable);
+//-------------------------------------------------------------------------------------
+void Entity::render(const fMatrix4& transParent, RenderQueue& queue)
+{
+	fMatrix4 transform = m_transform * transParent;
 
-		queue.pushRenderable(entityRenderable);
-	});
+	//not added yet, moved to another queue, or the queue was cleared
+	RenderQueue* attachedQueue = m_renderables.empty() ? nullptr : m_renderables[0]->getQueue();
+	if (attachedQueue != &queue) {
+		detach();
+
+		//build renderables for all submodel of this model
+		if (m_renderables.empty()) {
+			m_model->visit(transform, [&queue, this](const fMatrix4& trans, const Model::MeshPart* meshPart) {
+				RenderablePtr entityRenderable = std::shared_ptr<Renderable>(new EntityRenderable());
+				((EntityRenderable*)entityRenderable.get())->build(queue.getDevice(), trans, m_model, meshPart, m_vs, m_ps);
+				entityRenderable->setShadingRate(m_shadingRate);
+				entityRenderable->setBlendState(m_blendState);
+				entityRenderable->setDepthStencilState(m_depthStencilState);
+				entityRenderable->setInstanceBuffer(m_instanceBuffer);
+				m_renderables.push_back(entityRenderable);
+			});
+			m_worldTransform = transform;
+		}
+
+		const uint8_t* viewConstants = (const uint8_t*)&(queue.getViewConstants());
+		for (RenderablePtr renderable : m_renderables) {
+			renderable->bindVSConstantBuffer(ConstantBuffer::VIEW_CONSTANT_SLOT, viewConstants);
+			renderable->bindPSConstantBuffer(ConstantBuffer::VIEW_CONSTANT_SLOT, viewConstants);
+			queue.pushRenderable(renderable);
+		}
+	}
+
+	//update transform of all submodel
+	if (m_worldTransform != transform) {
+		size_t index = 0;
+		m_model->visit(transform, [&index, this](const fMatrix4& trans, const Model::MeshPart* meshPart) {
+			((EntityRenderable*)m_renderables[index++].get())->setWorldTransform(trans);
+		});
+		m_worldTransform = transform;
+	}
+
+	//prepare shader, parameters(camera, lights...) may change every frame, constant buffers are rewritten in place
+	for (RenderablePtr renderable : m_renderables) {
+		m_vs->preRender(renderable->getWorldTransform(), renderable);
+		m_ps->preRender(renderable);
+	}
 
 	//call parent
 	SceneObject::render(transParent, queue);
@@ -65,4 +168,3 @@ void Entity::render(const fMatrix4& transParent, RenderQueue& queue)
 
 
 }
-
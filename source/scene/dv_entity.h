@@ -15,12 +15,17 @@ namespace davinci
 class EntityRenderable : public Renderable
 {
 public:
-	void build(const RenderDevice* device, const fMatrix4& transform, const Model::MeshPart* meshPart, VertexShaderPtr vs, PixelShaderPtr ps);
+	void build(const RenderDevice* device, const fMatrix4& transform, ConstModelPtr model, const Model::MeshPart* meshPart, VertexShaderPtr vs, PixelShaderPtr ps);
+	void setWorldTransform(const fMatrix4& transform) {
+		m_worldTransform = transform;
+	}
 
-	virtual ConstVertexBufferPtr getVertexBuffer(void) const;
+	virtual size_t getVertexStreamCounts(void) const;
+	virtual ConstVertexBufferPtr getVertexStream(size_t index) const;
 	virtual ConstIndexBufferPtr getIndexBuffer(void) const;
 
 protected:
+	ConstModelPtr m_model; //keep mesh part alive while the renderable is in queue
 	const Model::MeshPart* m_meshPart;
 };
 
@@ -28,12 +33,35 @@ class Entity : public SceneObject
 {
 public:
 	void build(const fMatrix4& transform, ConstModelPtr model, VertexShaderPtr vs, PixelShaderPtr ps);
+	//renderables are added to queue at the first time, after that only transform and shader parameters are updated
 	virtual void render(const fMatrix4& transParent, RenderQueue& queue);
+	//remove renderables from the queue they were added to
+	void detach(void);
+	//variable-rate shading of all renderables
+	void setShadingRate(ShadingRate shadingRate);
+	//blend state of all renderables
+	void setBlendState(const BlendState& blendState);
+	//depth/stencil state of all renderables
+	void setDepthStencilState(const DepthStencilState& depthStencilState);
+	//draw all renderables once per instance, null to draw once
+	void setInstanceBuffer(ConstInstanceBufferPtr instanceBuffer);
 
 private:
 	ConstModelPtr m_model;
 	VertexShaderPtr m_vs;
 	PixelShaderPtr m_ps;
+
+	//retained renderables, one for each mesh part
+	std::vector<RenderablePtr> m_renderables;
+	fMatrix4 m_worldTransform;
+	ShadingRate m_shadingRate;
+	BlendState m_blendState;
+	DepthStencilState m_depthStencilState;
+	ConstInstanceBufferPtr m_instanceBuffer;
+
+public:
+	Entity();
+	virtual ~Entity();
 };
 
 }
@@ -18,7 +18,7 @@ protected:
 
 public:
 	SceneObject();
-	~SceneObject();
+	virtual ~SceneObject();
 };
 
 }
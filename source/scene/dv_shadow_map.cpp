@@ -0,0 +1,196 @@
+#include "dv_precompiled.h"
+#include "dv_shadow_map.h"
+
+#include "pipe/dv_render_queue.h"
+
+namespace davinci
+{
+
+//-------------------------------------------------------------------------------------
+ShadowMap::ShadowMap()
+	: m_resolution(1024)
+	, m_cascadeCounts(1)
+	, m_shadowDistance(0.f)
+	, m_filter(SF_PCF_2X2)
+	, m_depthBias(4.f)
+	, m_lightDir(0.f, -1.f, 0.f)
+{
+}
+
+//-------------------------------------------------------------------------------------
+ShadowMap::~ShadowMap()
+{
+}
+
+//-------------------------------------------------------------------------------------
+void ShadowMap::render(const Camera& camera, RenderQueue& renderQueue)
+{
+	_updateCascades(camera);
+
+	for (int32_t i = 0; i < m_cascadeCounts; i++) {
+		Cascade& cascade = m_cascades[i];
+		cascade.depthBuffer.init(m_resolution, m_resolution);
+
+		renderQueue.setCamera(cascade.lightCamera);
+		renderQueue.processDepth(cascade.depthBuffer);
+	}
+	renderQueue.setCamera(camera);
+}
+
+//-------------------------------------------------------------------------------------
+void ShadowMap::_updateCascades(const Camera& camera)
+{
+	const float nearClip = camera.getNear();
+	const float farClip = camera.getFar();
+	const float distance = (m_shadowDistance > 0.f) ? MathUtil::min2(m_shadowDistance, farClip) : farClip;
+
+	//camera basis, the same as fMatrix4::lookatLH
+	const fVector3 forward = (camera.getLookat() - camera.getEye()).normalise();
+	const fVector3 right = camera.getUp().crossProduct(forward).normalise();
+	const fVector3 up = forward.crossProduct(right);
+	const float tanHalfFov = tanf(camera.getFov()*0.5f);
+
+	const fVector3 lightUp = (fabsf(m_lightDir.y) > 0.99f) ? fVector3::UNIT_Z : fVector3::UNIT_Y;
+	const fVector3 lightX = lightUp.crossProduct(m_lightDir).normalise();
+	const fVector3 lightY = m_lightDir.crossProduct(lightX);
+
+	const fMatrix4 matInvCamera = camera.getViewProjMatrix().inverse();
+
+	float sliceNear = nearClip;
+	for (int32_t i = 0; i < m_cascadeCounts; i++) {
+		Cascade& cascade = m_cascades[i];
+
+		//practical split scheme, average of logarithmic and uniform split
+		const float t = (float)(i + 1) / (float)m_cascadeCounts;
+		const float sliceFar = 0.5f*(nearClip*powf(distance / nearClip, t)) + 0.5f*(nearClip + (distance - nearClip)*t);
+
+		//bounding sphere of the frustum slice, stable when camera rotates
+		fVector3 corners[8];
+		const float depth[2] = { sliceNear, sliceFar };
+		for (int32_t j = 0; j < 2; j++) {
+			float halfHeight = camera.isOrthographic() ? 0.f : depth[j] * tanHalfFov;
+			float halfWidth = halfHeight*camera.getAspect();
+			fVector3 center = camera.getEye() + forward*depth[j];
+
+			corners[j * 4 + 0] = center - right*halfWidth - up*halfHeight;
+			corners[j * 4 + 1] = center + right*halfWidth - up*halfHeight;
+			corners[j * 4 + 2] = center - right*halfWidth + up*halfHeight;
+			corners[j * 4 + 3] = center + right*halfWidth + up*halfHeight;
+		}
+		fVector3 center = fVector3::ZERO;
+		for (const fVector3& corner : corners) center += corner;
+		center = center / 8.f;
+
+		float radius = 0.f;
+		for (const fVector3& corner : corners) radius = MathUtil::max2(radius, (corner - center).length());
+
+		//snap to texel, so shadow edges do not shimmer
+		const float texelSize = radius * 2.f / (float)m_resolution;
+		const float cx = center.dotProduct(lightX), cy = center.dotProduct(lightY);
+		center += lightX*(floorf(cx / texelSize)*texelSize - cx) + lightY*(floorf(cy / texelSize)*texelSize - cy);
+
+		//casters between light and the slice are also rendered
+		const float backOff = radius + distance;
+		cascade.lightCamera.setEye(center - m_lightDir*backOff, false);
+		cascade.lightCamera.setLookat(center, false);
+		cascade.lightCamera.setUp(lightUp, false);
+		cascade.lightCamera.setClipRange(0.f, backOff + radius, false);
+		cascade.lightCamera.setOrthographic(radius*2.f, radius*2.f);
+
+		cascade.matCameraToLight = matInvCamera * cascade.lightCamera.getViewProjMatrix();
+		cascade.splitDepth = camera.isOrthographic() ?
+			(sliceFar - nearClip) / (farClip - nearClip) :
+			farClip / (farClip - nearClip) * (1.f - nearClip / sliceFar);
+		cascade.depthBias = m_depthBias * texelSize / (backOff + radius);
+
+		sliceNear = sliceFar;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+float ShadowMap::getShadow(const fVector3& posNDC) const
+{
+	int32_t index = 0;
+	while (index < m_cascadeCounts && posNDC.z > m_cascades[index].splitDepth) index++;
+	if (index >= m_cascadeCounts) return 1.f;
+
+	const Cascade& cascade = m_cascades[index];
+	const fVector3 posLight = posNDC * cascade.matCameraToLight;
+
+	//NDC -> texel space, the same as primitive assembler
+	const float half = (float)m_resolution * 0.5f;
+	return _sampleCascade(cascade.depthBuffer, posLight.x*half + half, posLight.y*half + half, posLight.z - cascade.depthBias);
+}
+
+//-------------------------------------------------------------------------------------
+//4 taps are fetched and compared at a time, written as plain loops over arrays so the 
+//compiler can vectorise them
+static inline void _fetch4(const DepthBuffer& depthBuffer, const int32_t x[4], const int32_t y[4], float depth[4])
+{
+	const int32_t width = depthBuffer.getWidth(), height = depthBuffer.getHeight();
+	for (int32_t i = 0; i < 4; i++) {
+		//outside of shadow map is lit
+		depth[i] = (x[i] >= 0 && x[i] < width && y[i] >= 0 && y[i] < height) ?
+			depthBuffer.getPixel(x[i], y[i]) : std::numeric_limits<float>::max();
+	}
+}
+
+//-------------------------------------------------------------------------------------
+static inline float _compare4(const float depth[4], const float weight[4], float reference)
+{
+	float lit[4];
+	for (int32_t i = 0; i < 4; i++) {
+		lit[i] = (reference <= depth[i]) ? weight[i] : 0.f;
+	}
+	return (lit[0] + lit[1]) + (lit[2] + lit[3]);
+}
+
+//-------------------------------------------------------------------------------------
+float ShadowMap::_sampleCascade(const DepthBuffer& depthBuffer, float x, float y, float depth) const
+{
+	float taps[4];
+
+	switch (m_filter) {
+	case SF_NONE:
+	{
+		int32_t tx = (int32_t)floorf(x), ty = (int32_t)floorf(y);
+		if (tx < 0 || tx >= depthBuffer.getWidth() || ty < 0 || ty >= depthBuffer.getHeight()) return 1.f;
+		return depth <= depthBuffer.getPixel(tx, ty) ? 1.f : 0.f;
+	}
+
+	case SF_PCF_2X2:
+	{
+		//texel centers are at +0.5
+		const float fx = x - 0.5f, fy = y - 0.5f;
+		const int32_t x0 = (int32_t)floorf(fx), y0 = (int32_t)floorf(fy);
+		const float sx = fx - (float)x0, sy = fy - (float)y0;
+
+		const int32_t tx[4] = { x0, x0 + 1, x0, x0 + 1 };
+		const int32_t ty[4] = { y0, y0, y0 + 1, y0 + 1 };
+		const float weight[4] = { (1.f - sx)*(1.f - sy), sx*(1.f - sy), (1.f - sx)*sy, sx*sy };
+
+		_fetch4(depthBuffer, tx, ty, taps);
+		return _compare4(taps, weight, depth);
+	}
+
+	default:
+	{
+		const int32_t cx = (int32_t)floorf(x), cy = (int32_t)floorf(y);
+		const float w = 1.f / 9.f;
+
+		//9 taps as 3 groups of 4, the last 3 lanes are padding with zero weight
+		const int32_t tx[12] = { cx - 1, cx, cx + 1, cx - 1, cx, cx + 1, cx - 1, cx, cx + 1, cx, cx, cx };
+		const int32_t ty[12] = { cy - 1, cy - 1, cy - 1, cy, cy, cy, cy + 1, cy + 1, cy + 1, cy, cy, cy };
+		const float weight[12] = { w, w, w, w, w, w, w, w, w, 0.f, 0.f, 0.f };
+
+		float shadow = 0.f;
+		for (int32_t i = 0; i < 12; i += 4) {
+			_fetch4(depthBuffer, tx + i, ty + i, taps);
+			shadow += _compare4(taps, weight + i, depth);
+		}
+		return shadow;
+	}
+	}
+}
+
+}
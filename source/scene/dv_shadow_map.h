@@ -0,0 +1,90 @@
+#pragma once
+
+#include "dv_prerequisites.h"
+
+//to be remove
+#include "device/dv_depth_buffer.h"
+#include "dv_camera.h"
+
+namespace davinci
+{
+
+//Cascaded shadow map of a directional light
+class ShadowMap
+{
+public:
+	enum { MAX_CASCADE_COUNTS = 4 };
+
+	enum Filter
+	{
+		SF_NONE,		//one tap
+		SF_PCF_2X2,		//bilinear weighted 2x2 taps
+		SF_PCF_3X3,		//box filtered 3x3 taps
+	};
+
+	//width and height of each cascade, in texels
+	void setResolution(int32_t resolution) {
+		m_resolution = resolution;
+	}
+	int32_t getResolution(void) const { return m_resolution; }
+
+	void setCascadeCounts(int32_t cascadeCounts) {
+		m_cascadeCounts = MathUtil::saturate(cascadeCounts, 1, (int32_t)MAX_CASCADE_COUNTS);
+	}
+	int32_t getCascadeCounts(void) const { return m_cascadeCounts; }
+
+	//view distance covered by cascades, 0 means far clip of camera
+	void setShadowDistance(float distance) {
+		m_shadowDistance = distance;
+	}
+
+	void setFilter(Filter filter) {
+		m_filter = filter;
+	}
+
+	//in texels of shadow map, so it fits every cascade and resolution
+	void setDepthBias(float depthBias) {
+		m_depthBias = depthBias;
+	}
+
+	void setLightDir(const fVector3& lightDir) {
+		m_lightDir = lightDir;
+	}
+
+	//render all cascades for camera, renderQueue must be prepared with the same camera(Scene::render), 
+	//camera of renderQueue is restored after rendering
+	void render(const Camera& camera, RenderQueue& renderQueue);
+
+	//return 0 if fully shadowed and 1 if lit, posNDC is the position output by vertex shader of camera
+	float getShadow(const fVector3& posNDC) const;
+
+	const DepthBuffer& getDepthBuffer(int32_t cascade) const { return m_cascades[cascade].depthBuffer; }
+
+private:
+	void _updateCascades(const Camera& camera);
+	float _sampleCascade(const DepthBuffer& depthBuffer, float x, float y, float depth) const;
+
+private:
+	struct Cascade
+	{
+		DepthBuffer depthBuffer;
+		Camera lightCamera;
+		fMatrix4 matCameraToLight;	//NDC of camera -> NDC of light
+		float splitDepth;			//far end of this cascade, in NDC z of camera
+		float depthBias;			//in NDC z of light
+	};
+
+	int32_t m_resolution;
+	int32_t m_cascadeCounts;
+	float m_shadowDistance;
+	Filter m_filter;
+	float m_depthBias;
+	fVector3 m_lightDir;
+	Cascade m_cascades[MAX_CASCADE_COUNTS];
+
+public:
+	ShadowMap();
+	~ShadowMap();
+};
+
+}
@@ -512,20 +512,11 @@ static void _buildDemoTriangles(void)
 //-------------------------------------------------------------------------------------
 void foo(void)
 {
-	Rasterizer::DebugParam debug;
-	debug.debug = true;
-	debug.x = 681;
-	debug.y = 190;
-	debug.tile_id = 42;
-	debug.coarse_id = 14;
-	debug.fine_id = 14;
-	debug.edge_id = 0; 
-	
 	{
 		fVector3 v0(1, 2, 0), v1(7, 4, 0), v2(5, 2, 0);
 		Rasterizer::drawTriangleLarrabee(1024, 1024, v0, v1, v2, [](const std::pair<int32_t, int32_t>& pos, const fVector3&) {
 			printf("%d, %d\n", pos.first, pos.second);
-		}, &debug);
+		});
 	}
 	return;
 
@@ -534,14 +525,14 @@ void foo(void)
 		fVector3 v0(824.796997f, 272.355164f, 0), v1(651.741699f, 173.502167f, 0), v2(787.095825f, 323.581726f, 0);
 		Rasterizer::drawTriangleLarrabee(1024, 1024, v0, v1, v2, [](const std::pair<int32_t, int32_t>& pos, const fVector3&) {
 			//printf("%d, %d\n", pos.first, pos.second);
-		}, &debug);
+		});
 	}
 
 	{
 		fVector3 v0(651.741699f, 173.502167f, 0), v1(824.796997f, 272.355164f, 0), v2(1024.f, 0.f, 0);
 		Rasterizer::drawTriangleLarrabee(1024, 1024, v0, v1, v2, [](const std::pair<int32_t, int32_t>& pos, const fVector3&) {
 			//printf("%d, %d\n", pos.first, pos.second);
-		}, &debug);
+		});
 	}
 }
 
@@ -0,0 +1,111 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+//blend one pixel of src over dest at (1, 2), return the color of render target
+static fVector4 _blendPixel(const BlendState& blendState, const fVector4& src, const fVector4& dest)
+{
+	RenderTarget renderTarget;
+	renderTarget.init(8, 8);
+	renderTarget.getColorBuffer().setPixel(1, 2, dest);
+
+	PixelBlock block;
+	block.x0 = 0;
+	block.y0 = 0;
+	block.mask = 1u << (2 * PixelBlock::SIZE + 1);
+	block.color[2 * PixelBlock::SIZE + 1] = src;
+	block.depth[2 * PixelBlock::SIZE + 1] = 0.5f;
+
+	renderTarget.blendBlock(block, blendState, DepthStencilState::makeDefault());
+	return renderTarget.getColorBuffer().getPixel(1, 2);
+}
+
+//-------------------------------------------------------------------------------------
+TEST(BlendState, Factor)
+{
+	const fVector4 src(1.f, 0.5f, 0.f, 0.25f), dest(0.f, 0.5f, 1.f, 0.5f);
+
+	fVector4 color = _blendPixel(BlendState::makeAlphaBlend(), src, dest);
+	EXPECT_EQ(color, fVector4(0.25f, 0.5f, 0.75f, 0.625f));
+
+	color = _blendPixel(BlendState::makeAdditive(), src, dest);
+	EXPECT_EQ(color, fVector4(1.f, 1.f, 1.f, 0.75f));
+
+	//opaque state keeps src
+	color = _blendPixel(BlendState::makeOpaque(), src, dest);
+	EXPECT_EQ(color, src);
+
+	BlendState state = BlendState::makeAdditive();
+	state.srcBlend = BF_DEST_COLOR;
+	state.destBlend = BF_INV_SRC_COLOR;
+	state.srcBlendAlpha = BF_DEST_ALPHA;
+	state.destBlendAlpha = BF_INV_DEST_ALPHA;
+	color = _blendPixel(state, src, dest);
+	EXPECT_EQ(color, fVector4(0.f, 0.5f, 1.f, 0.375f));
+
+	state.srcBlend = BF_INV_DEST_COLOR;
+	state.destBlend = BF_SRC_COLOR;
+	state.srcBlendAlpha = BF_ZERO;
+	state.destBlendAlpha = BF_INV_SRC_ALPHA;
+	color = _blendPixel(state, src, dest);
+	EXPECT_EQ(color, fVector4(1.f, 0.5f, 0.f, 0.375f));
+}
+
+//-------------------------------------------------------------------------------------
+TEST(BlendState, Op)
+{
+	const fVector4 src(1.f, 0.5f, 0.f, 0.25f), dest(0.f, 0.5f, 1.f, 0.5f);
+
+	BlendState state = BlendState::makeAdditive();
+	state.blendOp = state.blendOpAlpha = BO_SUBTRACT;
+	EXPECT_EQ(_blendPixel(state, src, dest), fVector4(1.f, 0.f, -1.f, -0.25f));
+
+	state.blendOp = state.blendOpAlpha = BO_REV_SUBTRACT;
+	EXPECT_EQ(_blendPixel(state, src, dest), fVector4(-1.f, 0.f, 1.f, 0.25f));
+
+	//factors are ignored by min and max
+	state.srcBlend = state.destBlend = BF_ZERO;
+	state.blendOp = state.blendOpAlpha = BO_MIN;
+	EXPECT_EQ(_blendPixel(state, src, dest), fVector4(0.f, 0.5f, 0.f, 0.25f));
+
+	state.blendOp = state.blendOpAlpha = BO_MAX;
+	EXPECT_EQ(_blendPixel(state, src, dest), fVector4(1.f, 0.5f, 1.f, 0.5f));
+}
+
+//-------------------------------------------------------------------------------------
+TEST(BlendState, BlockMask)
+{
+	RenderTarget renderTarget;
+	renderTarget.init(8, 8);
+	for (int32_t y = 0; y < 8; y++) {
+		for (int32_t x = 0; x < 8; x++) {
+			renderTarget.getColorBuffer().setPixel(x, y, fVector4(0.f, 0.f, 1.f, 1.f));
+		}
+	}
+
+	//odd pixels of the second block are covered
+	PixelBlock block;
+	block.x0 = 4;
+	block.y0 = 4;
+	block.mask = 0xAAAA;
+	for (int32_t i = 0; i < PixelBlock::PIXEL_COUNTS; i++) {
+		block.color[i] = fVector4(1.f, 0.f, 0.f, 0.5f);
+		block.depth[i] = 0.5f;
+	}
+	renderTarget.blendBlock(block, BlendState::makeAlphaBlend(), DepthStencilState::makeDefault());
+
+	for (int32_t i = 0; i < PixelBlock::PIXEL_COUNTS; i++) {
+		const fVector4& color = renderTarget.getColorBuffer().getPixel(4 + (i % PixelBlock::SIZE), 4 + (i / PixelBlock::SIZE));
+		if (i & 1) {
+			EXPECT_EQ(color, fVector4(0.5f, 0.f, 0.5f, 1.f));
+		}
+		else {
+			EXPECT_EQ(color, fVector4(0.f, 0.f, 1.f, 1.f));
+		}
+	}
+	EXPECT_EQ(renderTarget.getColorBuffer().getPixel(1, 1), fVector4(0.f, 0.f, 1.f, 1.f));
+	EXPECT_EQ(renderTarget.getDepthBuffer().getPixel(5, 4), 0.5f);
+	EXPECT_EQ(renderTarget.getDepthBuffer().getPixel(4, 4), std::numeric_limits<float>::max());
+}
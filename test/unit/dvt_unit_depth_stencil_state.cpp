@@ -0,0 +1,135 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+TEST(DepthStencilState, CompareFunc)
+{
+	const CompareFunc funcs[] = { CF_NEVER, CF_LESS, CF_EQUAL, CF_LESS_EQUAL, CF_GREATER, CF_NOT_EQUAL, CF_GREATER_EQUAL, CF_ALWAYS };
+	//value(less, equal, greater than reference) passed
+	const bool expect[][3] = {
+		{ false, false, false },
+		{ true, false, false },
+		{ false, true, false },
+		{ true, true, false },
+		{ false, false, true },
+		{ true, false, true },
+		{ false, true, true },
+		{ true, true, true },
+	};
+
+	for (size_t i = 0; i < sizeof(funcs) / sizeof(funcs[0]); i++) {
+		EXPECT_EQ(compareValue(funcs[i], 0.25f, 0.5f), expect[i][0]);
+		EXPECT_EQ(compareValue(funcs[i], 0.5f, 0.5f), expect[i][1]);
+		EXPECT_EQ(compareValue(funcs[i], 0.75f, 0.5f), expect[i][2]);
+
+		EXPECT_EQ(compareValue(funcs[i], (uint8_t)1, (uint8_t)2), expect[i][0]);
+		EXPECT_EQ(compareValue(funcs[i], (uint8_t)2, (uint8_t)2), expect[i][1]);
+		EXPECT_EQ(compareValue(funcs[i], (uint8_t)3, (uint8_t)2), expect[i][2]);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+TEST(DepthStencilState, StencilOp)
+{
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_KEEP, 7, 3), 7);
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_ZERO, 7, 3), 0);
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_REPLACE, 7, 3), 3);
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_INVERT, 0x0F, 3), 0xF0);
+
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_INCR_SAT, 7, 3), 8);
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_INCR_SAT, 0xFF, 3), 0xFF);
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_DECR_SAT, 7, 3), 6);
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_DECR_SAT, 0, 3), 0);
+
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_INCR_WRAP, 0xFF, 3), 0);
+	EXPECT_EQ(DepthStencilState::applyStencilOp(SO_DECR_WRAP, 0, 3), 0xFF);
+}
+
+//-------------------------------------------------------------------------------------
+//one block of the same color and depth, all pixels covered
+static void _fillBlock(RenderTarget& renderTarget, const fVector4& color, float depth, const DepthStencilState& state)
+{
+	PixelBlock block;
+	block.x0 = block.y0 = 0;
+	block.mask = 0xFFFF;
+	for (int32_t i = 0; i < PixelBlock::PIXEL_COUNTS; i++) {
+		block.color[i] = color;
+		block.depth[i] = depth;
+	}
+	renderTarget.blendBlock(block, BlendState::makeOpaque(), state);
+}
+
+//-------------------------------------------------------------------------------------
+TEST(DepthStencilState, StencilMask)
+{
+	RenderTarget renderTarget;
+	renderTarget.init(4, 4);
+	//occluder at the left half
+	for (int32_t y = 0; y < 4; y++) {
+		renderTarget.getDepthBuffer().setPixel(0, y, 0.25f);
+		renderTarget.getDepthBuffer().setPixel(1, y, 0.25f);
+	}
+
+	//mark pixels passed depth test with 2, pixels failed with 1, depth is kept
+	DepthStencilState mark = DepthStencilState::makeDefault();
+	mark.depthWrite = false;
+	mark.stencilEnable = true;
+	mark.stencilRef = 2;
+	mark.passOp = SO_REPLACE;
+	mark.depthFailOp = SO_INCR_SAT;
+	_fillBlock(renderTarget, fVector4(1.f, 0.f, 0.f, 1.f), 0.5f, mark);
+
+	EXPECT_EQ(renderTarget.getDepthBuffer().getStencil(0, 0), 1);
+	EXPECT_EQ(renderTarget.getDepthBuffer().getStencil(3, 3), 2);
+	EXPECT_EQ(renderTarget.getDepthBuffer().getPixel(3, 3), std::numeric_limits<float>::max());
+	EXPECT_EQ(renderTarget.getColorBuffer().getPixel(0, 0), fVector4::BLACK);
+	EXPECT_EQ(renderTarget.getColorBuffer().getPixel(3, 0), fVector4(1.f, 0.f, 0.f, 1.f));
+
+	//write mask keeps the high bits
+	DepthStencilState wrap = mark;
+	wrap.depthEnable = false;
+	wrap.stencilFunc = CF_ALWAYS;
+	wrap.passOp = SO_DECR_WRAP;
+	wrap.stencilWriteMask = 0x0F;
+	_fillBlock(renderTarget, fVector4::BLACK, 0.5f, wrap);
+	EXPECT_EQ(renderTarget.getDepthBuffer().getStencil(0, 0), 0x00);
+	EXPECT_EQ(renderTarget.getDepthBuffer().getStencil(3, 3), 0x01);
+
+	_fillBlock(renderTarget, fVector4::BLACK, 0.5f, wrap);
+	EXPECT_EQ(renderTarget.getDepthBuffer().getStencil(0, 0), 0x0F);
+
+	//draw where stencil equals the reference only
+	renderTarget.getDepthBuffer().setStencil(2, 1, 5);
+	DepthStencilState test = DepthStencilState::makeDefault();
+	test.depthEnable = false;
+	test.stencilEnable = true;
+	test.stencilRef = 5;
+	test.stencilFunc = CF_EQUAL;
+	EXPECT_TRUE(renderTarget.earlyTest(2, 1, 0.5f, test));
+	EXPECT_FALSE(renderTarget.earlyTest(2, 2, 0.5f, test));
+
+	_fillBlock(renderTarget, fVector4(0.f, 1.f, 0.f, 1.f), 0.5f, test);
+	EXPECT_EQ(renderTarget.getColorBuffer().getPixel(2, 1), fVector4(0.f, 1.f, 0.f, 1.f));
+	EXPECT_EQ(renderTarget.getColorBuffer().getPixel(2, 2), fVector4::BLACK);
+}
+
+//-------------------------------------------------------------------------------------
+TEST(DepthStencilState, DepthEqual)
+{
+	RenderTarget renderTarget;
+	renderTarget.init(4, 4);
+	renderTarget.getDepthBuffer().setPixel(1, 1, 0.5f);
+
+	//shading pass after a Z-prepass, depth is tested but not written
+	const DepthStencilState state = DepthStencilState::makeDepthEqual();
+	EXPECT_TRUE(renderTarget.earlyTest(1, 1, 0.5f, state));
+	EXPECT_FALSE(renderTarget.earlyTest(1, 1, 0.25f, state));
+
+	renderTarget.setPixel(1, 1, fVector4(1.f, 1.f, 1.f, 1.f), 0.5f, state);
+	renderTarget.setPixel(2, 1, fVector4(1.f, 1.f, 1.f, 1.f), 0.25f, state);
+	EXPECT_EQ(renderTarget.getColorBuffer().getPixel(1, 1), fVector4(1.f, 1.f, 1.f, 1.f));
+	EXPECT_EQ(renderTarget.getColorBuffer().getPixel(2, 1), fVector4::BLACK);
+	EXPECT_EQ(renderTarget.getDepthBuffer().getPixel(2, 1), std::numeric_limits<float>::max());
+}
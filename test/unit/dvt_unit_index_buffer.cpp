@@ -0,0 +1,32 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+TEST(IndexBuffer, Format)
+{
+	RenderDevice device;
+
+	uint16_t indices16[] = { 0, 1, 2, IndexBuffer::RESTART_INDEX16 };
+	IndexBuffer indexBuffer16;
+	indexBuffer16.build(&device, indices16, 4);
+	EXPECT_EQ(indexBuffer16.getFormat(), IF_UINT16);
+	EXPECT_EQ(indexBuffer16.counts(), 4u);
+	EXPECT_EQ(indexBuffer16.get(3), indexBuffer16.getRestartIndex());
+
+	//vertices beyond 16-bit range
+	uint32_t indices32[] = { 0, 70000, 65535, IndexBuffer::RESTART_INDEX32 };
+	IndexBuffer indexBuffer32;
+	indexBuffer32.build(&device, indices32, 4);
+	EXPECT_EQ(indexBuffer32.getFormat(), IF_UINT32);
+	EXPECT_EQ(indexBuffer32.counts(), 4u);
+	EXPECT_EQ(indexBuffer32.get(1), 70000u);
+	EXPECT_EQ(((const uint32_t*)indexBuffer32.rawPtr())[2], 65535u);
+	EXPECT_EQ(indexBuffer32.get(3), indexBuffer32.getRestartIndex());
+
+	indexBuffer32.buildDynamic(&device, 2, IF_UINT32);
+	((uint32_t*)indexBuffer32.map())[1] = 100000;
+	indexBuffer32.unmap();
+	EXPECT_EQ(indexBuffer32.get(1), 100000u);
+}
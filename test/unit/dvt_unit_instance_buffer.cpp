@@ -0,0 +1,268 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+//moves position by x offset of the instance, records the instance bound to each vertex
+class InstanceOffsetVS : public VertexShader
+{
+public:
+	virtual void preRender(const fMatrix4& worldTransform, RenderablePtr renderable) const {}
+	virtual void vsFunction(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const {
+		const float* offset = (const float*)constantBuffer->getBuffer(ConstantBuffer::INSTANCE_CONSTANT_SLOT);
+		output[0] = input[0] + *offset;
+		output[1] = input[1];
+		output[2] = input[2];
+		invZ = 1.f;
+
+		m_instances.push_back(std::make_pair(constantBuffer->getInstanceID(), (const void*)offset));
+	}
+	virtual const VertexDesc& getOutputVertexDesc(void) const { return m_desc; }
+
+	VertexDesc m_desc;
+	mutable std::vector<std::pair<uint32_t, const void*>> m_instances;
+
+	InstanceOffsetVS() { m_desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3); }
+};
+
+//-------------------------------------------------------------------------------------
+class WhitePS : public PixelShader
+{
+public:
+	virtual void preRender(RenderablePtr renderable) const {}
+	virtual void psFunction(const ConstantBuffer* constantBuffer, const float* input, fVector4& color, float& depth) const {
+		color = fVector4::WHITE;
+		depth = input[2];
+	}
+};
+
+//-------------------------------------------------------------------------------------
+//one clockwise triangle around(-0.5, 0) drawn twice, the second instance is moved to (0.5, 0)
+class InstancedTriangle : public Renderable
+{
+public:
+	virtual size_t getVertexStreamCounts(void) const { return 1; }
+	virtual ConstVertexBufferPtr getVertexStream(size_t index) const { return m_vertexBuffer; }
+	virtual ConstIndexBufferPtr getIndexBuffer(void) const { return m_indexBuffer; }
+
+	VertexBufferPtr m_vertexBuffer;
+	IndexBufferPtr m_indexBuffer;
+	InstanceBufferPtr m_instanceBuffer;
+
+	InstancedTriangle(RenderDevice* device, ConstVertexShaderPtr vs, ConstPixelShaderPtr ps) {
+		m_primitiveType = PT_TRIANGLE_LIST;
+		m_vs = vs;
+		m_ps = ps;
+		m_vsConstantBuffer = std::make_shared<ConstantBuffer>(device);
+		m_psConstantBuffer = std::make_shared<ConstantBuffer>(device);
+
+		VertexDesc desc;
+		desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3);
+		float vertices[] = { -0.75f, -0.25f, 0.5f, -0.5f, 0.25f, 0.5f, -0.25f, -0.25f, 0.5f };
+		m_vertexBuffer = std::make_shared<VertexBuffer>();
+		m_vertexBuffer->build(device, desc, vertices, 3);
+
+		uint16_t indices[] = { 0, 1, 2 };
+		m_indexBuffer = std::make_shared<IndexBuffer>();
+		m_indexBuffer->build(device, indices, 3);
+
+		float offsets[] = { 0.f, 1.f };
+		m_instanceBuffer = std::make_shared<InstanceBuffer>();
+		m_instanceBuffer->build(device, sizeof(float), 2, offsets);
+		setInstanceBuffer(m_instanceBuffer);
+	}
+};
+
+//-------------------------------------------------------------------------------------
+TEST(InstanceBuffer, BindInstance)
+{
+	RenderDevice device;
+
+	fMatrix4 transforms[] = { fMatrix4::makeTrans(1.f, 0.f, 0.f), fMatrix4::makeTrans(2.f, 0.f, 0.f) };
+	InstanceBuffer instanceBuffer;
+	instanceBuffer.build(&device, sizeof(fMatrix4), 2, transforms);
+	EXPECT_EQ(instanceBuffer.counts(), 2u);
+
+	fMatrix4 transform = fMatrix4::makeTrans(3.f, 0.f, 0.f);
+	instanceBuffer.setInstance(1, &transform);
+
+	ConstantBuffer renderableConstants(&device);
+	float world = 1.f;
+	renderableConstants.setBuffer(0, (const uint8_t*)&world, sizeof(world));
+
+	//renderable constants are shared, instance slot and id are per instance
+	ConstantBuffer instanceConstants(&device);
+	instanceConstants.bindInstance(renderableConstants, instanceBuffer.ptr(1), 1);
+	EXPECT_EQ(instanceConstants.getBuffer(0), renderableConstants.getBuffer(0));
+	EXPECT_EQ(instanceConstants.getInstanceID(), 1u);
+	EXPECT_EQ(*(const fMatrix4*)instanceConstants.getBuffer(ConstantBuffer::INSTANCE_CONSTANT_SLOT), transform);
+	EXPECT_EQ(renderableConstants.getBuffer(ConstantBuffer::INSTANCE_CONSTANT_SLOT), nullptr);
+}
+
+//-------------------------------------------------------------------------------------
+TEST(InstanceBuffer, Pipeline)
+{
+	RenderDevice device;
+	std::shared_ptr<InstanceOffsetVS> vs = std::make_shared<InstanceOffsetVS>();
+	std::shared_ptr<InstancedTriangle> renderable = std::make_shared<InstancedTriangle>(&device, vs, std::make_shared<WhitePS>());
+
+	RenderQueue queue;
+	queue.setDevice(&device);
+	queue.pushRenderable(renderable);
+
+	//whole frame, one output node per instance
+	{
+		PrimitiveAfterAssember primitiveAfterAssember;
+		InputAssember::process(queue, true, primitiveAfterAssember);
+
+		PrimitiveAfterVS primitiveAfterVS;
+		VertexShader::process(&device, primitiveAfterAssember, primitiveAfterVS);
+		ASSERT_EQ(primitiveAfterVS.getNodeCounts(), 2u);
+
+		for (uint32_t i = 0; i < 2; i++) {
+			const ConstantBuffer* constantBuffer = primitiveAfterVS.getNode(i).vsConstantBuffer.get();
+			EXPECT_EQ(constantBuffer->getInstanceID(), i);
+			EXPECT_EQ(constantBuffer->getBuffer(ConstantBuffer::INSTANCE_CONSTANT_SLOT), renderable->m_instanceBuffer->ptr(i));
+		}
+		EXPECT_NE(primitiveAfterVS.getNode(0).vsConstantBuffer, primitiveAfterVS.getNode(1).vsConstantBuffer);
+	}
+
+	//streaming and whole frame, both instances reach the render target
+	const size_t chunkSizes[] = { RenderQueue::DEFAULT_STREAM_CHUNK_SIZE, 0 };
+	for (size_t chunkSize : chunkSizes) {
+		queue.setStreamChunkSize(chunkSize);
+		vs->m_instances.clear();
+
+		RenderTarget renderTarget;
+		renderTarget.init(64, 64);
+		queue.process(renderTarget);
+
+		//the chunk is assembled once, each instance shades its vertices with its own binding
+		ASSERT_EQ(vs->m_instances.size(), 6u);
+		for (size_t i = 0; i < 6; i++) {
+			EXPECT_EQ(vs->m_instances[i].first, (uint32_t)(i / 3));
+			EXPECT_EQ(vs->m_instances[i].second, renderable->m_instanceBuffer->ptr(i / 3));
+		}
+
+		EXPECT_EQ(renderTarget.getColorBuffer().getPixel(16, 32), fVector4::WHITE);
+		EXPECT_EQ(renderTarget.getColorBuffer().getPixel(48, 32), fVector4::WHITE);
+		EXPECT_EQ(renderTarget.getColorBuffer().getPixel(32, 32), fVector4::BLACK);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+//moves the triangle by (x, y) of the instance and puts it at depth z, ps shows the depth
+class InstanceMoveVS : public VertexShader
+{
+public:
+	virtual void preRender(const fMatrix4& worldTransform, RenderablePtr renderable) const {}
+	virtual void vsFunction(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const {
+		const fVector3* move = (const fVector3*)constantBuffer->getBuffer(ConstantBuffer::INSTANCE_CONSTANT_SLOT);
+		output[0] = input[0] + move->x;
+		output[1] = input[1] + move->y;
+		output[2] = move->z;
+		invZ = 1.f;
+	}
+	virtual const VertexDesc& getOutputVertexDesc(void) const { return m_desc; }
+
+	VertexDesc m_desc;
+
+	InstanceMoveVS() { m_desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3); }
+};
+
+//-------------------------------------------------------------------------------------
+class DepthPS : public PixelShader
+{
+public:
+	virtual void preRender(RenderablePtr renderable) const {}
+	virtual void psFunction(const ConstantBuffer* constantBuffer, const float* input, fVector4& color, float& depth) const {
+		color = fVector4(input[2], input[2], input[2], 1.f);
+		depth = input[2];
+	}
+};
+
+//-------------------------------------------------------------------------------------
+//small triangles scattered over the screen, more instances than draw ids of visibility buffer
+class ScatteredTriangles : public Renderable
+{
+public:
+	enum { INSTANCE_COUNTS = VisibilityBuffer::MAX_DRAW_COUNTS + 100 };
+
+	virtual size_t getVertexStreamCounts(void) const { return 1; }
+	virtual ConstVertexBufferPtr getVertexStream(size_t index) const { return m_vertexBuffer; }
+	virtual ConstIndexBufferPtr getIndexBuffer(void) const { return m_indexBuffer; }
+
+	VertexBufferPtr m_vertexBuffer;
+	IndexBufferPtr m_indexBuffer;
+	InstanceBufferPtr m_instanceBuffer;
+
+	ScatteredTriangles(RenderDevice* device, ConstVertexShaderPtr vs, ConstPixelShaderPtr ps) {
+		m_primitiveType = PT_TRIANGLE_LIST;
+		m_vs = vs;
+		m_ps = ps;
+		m_vsConstantBuffer = std::make_shared<ConstantBuffer>(device);
+		m_psConstantBuffer = std::make_shared<ConstantBuffer>(device);
+
+		VertexDesc desc;
+		desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3);
+		float vertices[] = { -0.25f, -0.25f, 0.f, 0.f, 0.25f, 0.f, 0.25f, -0.25f, 0.f };
+		m_vertexBuffer = std::make_shared<VertexBuffer>();
+		m_vertexBuffer->build(device, desc, vertices, 3);
+
+		uint16_t indices[] = { 0, 1, 2 };
+		m_indexBuffer = std::make_shared<IndexBuffer>();
+		m_indexBuffer->build(device, indices, 3);
+
+		//distinct depths in (0.1, 0.9), the first and the last instance are in front of all others
+		//and overlap around (-0.5, 0)
+		std::vector<fVector3> moves(INSTANCE_COUNTS);
+		for (size_t i = 0; i < INSTANCE_COUNTS; i++) {
+			moves[i].x = (float)(i * 37 % 101) / 100.f * 1.5f - 0.75f;
+			moves[i].y = (float)(i * 53 % 97) / 96.f * 1.5f - 0.75f;
+			moves[i].z = 0.1f + 0.8f * (float)(i * 7919 % INSTANCE_COUNTS) / (float)INSTANCE_COUNTS;
+		}
+		moves[0] = fVector3(-0.5f, 0.f, 0.02f);
+		moves[INSTANCE_COUNTS - 1] = fVector3(-0.4f, 0.f, 0.03f);
+
+		m_instanceBuffer = std::make_shared<InstanceBuffer>();
+		m_instanceBuffer->build(device, sizeof(fVector3), INSTANCE_COUNTS, &(moves[0]));
+		setInstanceBuffer(m_instanceBuffer);
+	}
+};
+
+//-------------------------------------------------------------------------------------
+TEST(InstanceBuffer, VisibilityBatches)
+{
+	RenderDevice device;
+	std::shared_ptr<ScatteredTriangles> renderable = std::make_shared<ScatteredTriangles>(&device, std::make_shared<InstanceMoveVS>(), std::make_shared<DepthPS>());
+
+	RenderQueue queue;
+	queue.setDevice(&device);
+	queue.pushRenderable(renderable);
+
+	RenderTarget forward;
+	forward.init(64, 64);
+	queue.process(forward);
+
+	//one node per instance, the draw ids run out and the rest goes to a second batch
+	VisibilityBuffer visibilityBuffer;
+	visibilityBuffer.init(64, 64);
+	RenderTarget visibility;
+	visibility.init(64, 64);
+	queue.processVisibility(visibilityBuffer, visibility);
+
+	int32_t mismatches = 0;
+	for (int32_t y = 0; y < 64; y++) {
+		for (int32_t x = 0; x < 64; x++) {
+			const fVector4& a = forward.getColorBuffer().getPixel(x, y);
+			const fVector4& b = visibility.getColorBuffer().getPixel(x, y);
+			if (fabsf(a.x - b.x) > 1e-5f || a.w != b.w) mismatches++;
+		}
+	}
+	EXPECT_EQ(mismatches, 0);
+
+	//first instance(first batch) covers the last one(second batch) where they overlap, the rest of the last is visible
+	EXPECT_NEAR(visibility.getColorBuffer().getPixel(16, 32).x, 0.02f, 1e-5f);
+	EXPECT_NEAR(visibility.getColorBuffer().getPixel(22, 32).x, 0.03f, 1e-5f);
+}
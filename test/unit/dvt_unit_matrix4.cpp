@@ -303,4 +303,20 @@ TEST(Math_Matrix4, Algorithm)
 			EXPECT_EQ_4X4_T_APPROX(m1, gm1_t, std::numeric_limits<float>::epsilon()*100);
 		}
 	}
+
+	//orthographic
+	{
+		for (int i = 0; i < 10; i++) {
+			float width = MathUtil::rangeRandom(0.1f, 100.f);
+			float height = MathUtil::rangeRandom(0.1f, 100.f);
+			float zNear = MathUtil::rangeRandom(-10.f, 10.f);
+			float zFar = zNear + MathUtil::rangeRandom(1.f, 1000.f);
+
+			fMatrix4 m1 = fMatrix4::orthoLH(width, height, zNear, zFar);
+			glm::mat4 gm1 = glm::orthoLH(-width*0.5f, width*0.5f, -height*0.5f, height*0.5f, zNear, zFar);
+			glm::mat4 gm1_t = glm::transpose(gm1);
+
+			EXPECT_EQ_4X4_T_APPROX(m1, gm1_t, std::numeric_limits<float>::epsilon()*100);
+		}
+	}
 }
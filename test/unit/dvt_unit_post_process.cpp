@@ -0,0 +1,66 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+TEST(PostProcess, GaussianBlur)
+{
+	const int32_t width = 100, height = 70;
+	PixelBuffer<fVector4> input, temp, output;
+	input.init(width, height, fVector4(0.5f, 0.25f, 1.f, 1.f));
+	temp.init(width, height, fVector4::BLACK);
+	output.init(width, height, fVector4::BLACK);
+
+	//a flat image stays flat
+	PostProcess::gaussianBlur(input, 4, 2.f, temp, output);
+	for (int32_t y = 0; y < height; y++) {
+		for (int32_t x = 0; x < width; x++) {
+			const fVector4& color = output.getPixel(x, y);
+			EXPECT_NEAR(color.x, 0.5f, 1e-5f);
+			EXPECT_NEAR(color.y, 0.25f, 1e-5f);
+			EXPECT_NEAR(color.z, 1.f, 1e-5f);
+		}
+	}
+
+	//energy of a single dot is kept and spread symmetrically
+	input.clear(fVector4::BLACK);
+	input.setPixel(50, 35, fVector4(1.f, 1.f, 1.f, 1.f));
+	PostProcess::gaussianBlur(input, 4, 2.f, temp, output);
+
+	float sum = 0.f;
+	for (int32_t y = 0; y < height; y++) {
+		for (int32_t x = 0; x < width; x++) {
+			sum += output.getPixel(x, y).x;
+		}
+	}
+	EXPECT_NEAR(sum, 1.f, 1e-4f);
+	EXPECT_FLOAT_EQ(output.getPixel(47, 35).x, output.getPixel(53, 35).x);
+	EXPECT_FLOAT_EQ(output.getPixel(50, 32).x, output.getPixel(50, 38).x);
+	EXPECT_GT(output.getPixel(50, 35).x, output.getPixel(51, 35).x);
+}
+
+//-------------------------------------------------------------------------------------
+TEST(PostProcess, DepthMipChain)
+{
+	const int32_t width = 13, height = 6;
+	PixelBuffer<float> depth;
+	depth.init(width, height, 0.5f);
+	depth.setPixel(12, 5, 0.9f);
+
+	MipChain<float> chain;
+	chain.init(width, height, 8, 0.f);
+
+	//7x3, 4x2, 2x1, 1x1
+	ASSERT_EQ(chain.getLevelCounts(), 4u);
+	EXPECT_EQ(chain.getLevel(0).getWidth(), 7);
+	EXPECT_EQ(chain.getLevel(0).getHeight(), 3);
+	EXPECT_EQ(chain.getLevel(3).getWidth(), 1);
+	EXPECT_EQ(chain.getLevel(3).getHeight(), 1);
+
+	//farthest depth of the odd last column is kept in every level
+	PostProcess::buildDepthMipChain(depth, chain);
+	EXPECT_FLOAT_EQ(chain.getLevel(0).getPixel(6, 2), 0.9f);
+	EXPECT_FLOAT_EQ(chain.getLevel(0).getPixel(0, 0), 0.5f);
+	EXPECT_FLOAT_EQ(chain.getLevel(3).getPixel(0, 0), 0.9f);
+}
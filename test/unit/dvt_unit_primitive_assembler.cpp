@@ -0,0 +1,274 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+#include <device/dv_device_buffer.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+static void _buildNode(const RenderDevice& device, const std::vector<fVector3>& positions, CullMode cullMode, PrimitiveAfterVS::Node& node)
+{
+	node.vertexSize = 3;
+	node.vertexCounts = positions.size();
+	node.vertexData = device.createDeviceBuffer(positions.size() * sizeof(fVector3));
+	node.primitiveType = PT_TRIANGLE_LIST;
+	node.cullMode = cullMode;
+	node.invZ.assign(positions.size(), 1.f);
+
+	memcpy(node.vertexData->ptr(0), &(positions[0]), positions.size() * sizeof(fVector3));
+}
+
+//-------------------------------------------------------------------------------------
+class PositionVS : public VertexShader
+{
+public:
+	virtual void preRender(const fMatrix4& worldTransform, RenderablePtr renderable) const {}
+	virtual void vsFunction(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const {
+		memcpy(output, input, sizeof(fVector3));
+		invZ = 1.f;
+	}
+	virtual const VertexDesc& getOutputVertexDesc(void) const { return m_desc; }
+
+	VertexDesc m_desc;
+
+	PositionVS() { m_desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3); }
+};
+
+//-------------------------------------------------------------------------------------
+//position phase reads position only, normal is read by attribute phase
+class NormalVS : public PositionVS
+{
+public:
+	virtual uint32_t getInputElementMask(bool attributePhase) const {
+		uint32_t mask = 1u << (uint32_t)VertexElementType::VET_POSITION;
+		if (attributePhase) mask |= 1u << (uint32_t)VertexElementType::VET_NORMAL;
+		return mask;
+	}
+};
+
+//-------------------------------------------------------------------------------------
+class StreamRenderable : public Renderable
+{
+public:
+	virtual size_t getVertexStreamCounts(void) const { return m_streams.size(); }
+	virtual ConstVertexBufferPtr getVertexStream(size_t index) const { return m_streams[index]; }
+	virtual ConstIndexBufferPtr getIndexBuffer(void) const { return m_indexBuffer; }
+
+	std::vector<VertexBufferPtr> m_streams;
+	IndexBufferPtr m_indexBuffer;
+
+	StreamRenderable(ConstVertexShaderPtr vs, PrimitiveType primitiveType) {
+		m_primitiveType = primitiveType;
+		m_vs = vs;
+		m_indexBuffer = std::make_shared<IndexBuffer>();
+	}
+};
+
+//-------------------------------------------------------------------------------------
+TEST(PrimitiveAssembler, Cull)
+{
+	RenderDevice device;
+	const int32_t targetWidth = 64, targetHeight = 64;
+
+	std::vector<fVector3> positions = {
+		//clockwise, visible
+		fVector3(-0.5f, -0.5f, 0.5f), fVector3(0.f, 0.5f, 0.5f), fVector3(0.5f, -0.5f, 0.5f),
+		//counter-clockwise
+		fVector3(-0.5f, -0.5f, 0.5f), fVector3(0.5f, -0.5f, 0.5f), fVector3(0.f, 0.5f, 0.5f),
+		//zero area
+		fVector3(-0.5f, -0.5f, 0.5f), fVector3(0.f, 0.f, 0.5f), fVector3(0.5f, 0.5f, 0.5f),
+		//outside of frustum
+		fVector3(1.5f, -0.5f, 0.5f), fVector3(2.f, 0.5f, 0.5f), fVector3(2.5f, -0.5f, 0.5f),
+		//behind far plane
+		fVector3(-0.5f, -0.5f, 1.5f), fVector3(0.f, 0.5f, 1.5f), fVector3(0.5f, -0.5f, 1.5f),
+		//between sample points(window coordinates: x in [32.1, 32.4])
+		fVector3(0.003125f, -0.5f, 0.5f), fVector3(0.00625f, 0.5f, 0.5f), fVector3(0.0125f, -0.5f, 0.5f),
+	};
+
+	{
+		PrimitiveAfterVS::Node node;
+		_buildNode(device, positions, CM_CCW, node);
+
+		CullStatistics statistics;
+		PrimitiveAssembler::processNode(targetWidth, targetHeight, node, statistics);
+
+		EXPECT_EQ(statistics.inputCounts, 6u);
+		EXPECT_EQ(statistics.backFace, 1u);
+		EXPECT_EQ(statistics.zeroArea, 1u);
+		EXPECT_EQ(statistics.frustum, 2u);
+		EXPECT_EQ(statistics.smallPrimitive, 1u);
+		EXPECT_EQ(statistics.culledCounts(), 5u);
+
+		ASSERT_EQ(node.primitives.size(), 3u);
+		EXPECT_EQ(node.primitives[0], 0u);
+		EXPECT_EQ(node.primitives[1], 1u);
+		EXPECT_EQ(node.primitives[2], 2u);
+		EXPECT_EQ(node.screenPos[1], fVector3(32.f, 48.f, 1.f));
+	}
+
+	{
+		PrimitiveAfterVS::Node node;
+		_buildNode(device, positions, CM_CW, node);
+
+		CullStatistics statistics;
+		PrimitiveAssembler::processNode(targetWidth, targetHeight, node, statistics);
+
+		EXPECT_EQ(statistics.backFace, 2u);
+		ASSERT_EQ(node.primitives.size(), 3u);
+		//counter-clockwise triangle should be flipped to rasterizer winding
+		EXPECT_EQ(node.primitives[0], 3u);
+		EXPECT_EQ(node.primitives[1], 5u);
+		EXPECT_EQ(node.primitives[2], 4u);
+	}
+
+	{
+		PrimitiveAfterVS::Node node;
+		_buildNode(device, positions, CM_NONE, node);
+
+		CullStatistics statistics;
+		PrimitiveAssembler::processNode(targetWidth, targetHeight, node, statistics);
+
+		EXPECT_EQ(statistics.backFace, 0u);
+		EXPECT_EQ(node.primitives.size(), 6u);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+TEST(PrimitiveAssembler, TriangleStrip)
+{
+	RenderDevice device;
+	const int32_t targetWidth = 64, targetHeight = 64;
+
+	//two quads, each one is a strip of two clockwise triangles
+	std::vector<fVector3> positions = {
+		fVector3(-0.5f, -0.5f, 0.5f), fVector3(-0.5f, 0.f, 0.5f), fVector3(0.5f, -0.5f, 0.5f), fVector3(0.5f, 0.f, 0.5f),
+		fVector3(-0.5f, 0.f, 0.5f), fVector3(-0.5f, 0.5f, 0.5f), fVector3(0.5f, 0.f, 0.5f), fVector3(0.5f, 0.5f, 0.5f),
+	};
+
+	{
+		PrimitiveAfterVS::Node node;
+		_buildNode(device, positions, CM_CCW, node);
+		node.primitiveType = PT_TRIANGLE_STRIP;
+		//restart between the quads
+		node.stripStarts = { 0, 4 };
+		node.stripParity = 0;
+
+		CullStatistics statistics;
+		PrimitiveAssembler::processNode(targetWidth, targetHeight, node, statistics);
+
+		EXPECT_EQ(statistics.inputCounts, 4u);
+		EXPECT_EQ(statistics.culledCounts(), 0u);
+		ASSERT_EQ(node.primitives.size(), 12u);
+		//odd triangle swaps the first two vertices
+		EXPECT_EQ(node.primitives[3], 2u);
+		EXPECT_EQ(node.primitives[4], 1u);
+		EXPECT_EQ(node.primitives[5], 3u);
+		EXPECT_EQ(node.primitives[6], 4u);
+	}
+
+	{
+		PrimitiveAfterVS::Node node;
+		_buildNode(device, positions, CM_CCW, node);
+		node.primitiveType = PT_TRIANGLE_STRIP;
+		//first strip continues from an odd triangle of last chunk
+		node.stripStarts = { 0, 4 };
+		node.stripParity = 1;
+
+		CullStatistics statistics;
+		PrimitiveAssembler::processNode(targetWidth, targetHeight, node, statistics);
+
+		EXPECT_EQ(statistics.inputCounts, 4u);
+		EXPECT_EQ(statistics.backFace, 2u);
+		ASSERT_EQ(node.primitives.size(), 6u);
+		EXPECT_EQ(node.primitives[0], 4u);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+TEST(InputAssember, StripChunk)
+{
+	RenderDevice device;
+	std::shared_ptr<PositionVS> vs = std::make_shared<PositionVS>();
+	std::shared_ptr<StreamRenderable> renderable = std::make_shared<StreamRenderable>(vs, PT_TRIANGLE_STRIP);
+
+	float vertices[7 * 3] = { 0 };
+	renderable->m_streams.push_back(std::make_shared<VertexBuffer>());
+	renderable->m_streams[0]->build(&device, vs->m_desc, vertices, 7);
+
+	//a chunk of restart indices only in the middle
+	const uint16_t R = IndexBuffer::RESTART_INDEX16;
+	uint16_t indices[] = { 0, 1, 2, 3, R, R, R, 4, 5, 6 };
+	renderable->m_indexBuffer->build(&device, indices, 10);
+	ASSERT_EQ(InputAssember::primitiveCounts(renderable), 8u);
+
+	//one primitive per chunk, parity is carried from the previous chunk
+	const uint32_t expectParity[8] = { 0, 1, 0, 1, 0, 0, 0, 0 };
+	const size_t expectVertices[8] = { 3, 3, 2, 1, 0, 1, 2, 3 };
+
+	PrimitiveAfterAssember::Node node;
+	uint32_t stripParity = 0;
+	for (size_t i = 0; i < 8; i++) {
+		ASSERT_TRUE(InputAssember::processChunk(&device, renderable, i, 1, stripParity, true, node));
+		EXPECT_EQ(node.stripParity, expectParity[i]);
+		EXPECT_EQ(node.vertexCounts, expectVertices[i]);
+		stripParity = node.nextStripParity;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+TEST(InputAssember, AttributeStream)
+{
+	RenderDevice device;
+	const int32_t targetWidth = 64, targetHeight = 64;
+	std::shared_ptr<NormalVS> vs = std::make_shared<NormalVS>();
+	std::shared_ptr<StreamRenderable> renderable = std::make_shared<StreamRenderable>(vs, PT_TRIANGLE_LIST);
+
+	//a clockwise triangle and a counter-clockwise one
+	float positions[] = {
+		-0.5f, -0.5f, 0.5f, 0.f, 0.5f, 0.5f, 0.5f, -0.5f, 0.5f,
+		-0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.f, 0.5f, 0.5f,
+	};
+	float normals[6 * 3];
+	for (size_t i = 0; i < 6 * 3; i++) normals[i] = (float)i;
+
+	VertexDesc normalDesc;
+	normalDesc.addElement(VertexElementType::VET_NORMAL, VertexElementFormat::VET_FLOAT_X3);
+	renderable->m_streams.push_back(std::make_shared<VertexBuffer>());
+	renderable->m_streams[0]->build(&device, vs->m_desc, positions, 6);
+	renderable->m_streams.push_back(std::make_shared<VertexBuffer>());
+	renderable->m_streams[1]->build(&device, normalDesc, normals, 6);
+
+	uint16_t indices[] = { 0, 1, 2, 3, 4, 5 };
+	renderable->m_indexBuffer->build(&device, indices, 6);
+
+	//depth-only passes never see the normal stream
+	PrimitiveAfterAssember::Node inputNode;
+	ASSERT_TRUE(InputAssember::processChunk(&device, renderable, 0, 2, 0, false, inputNode));
+	EXPECT_EQ(inputNode.vertexSize, 3u);
+	EXPECT_TRUE(inputNode.attributeStreams.empty());
+
+	//shading passes keep it for the attribute phase
+	ASSERT_TRUE(InputAssember::processChunk(&device, renderable, 0, 2, 0, true, inputNode));
+	ASSERT_EQ(inputNode.vertexSize, 6u);
+	ASSERT_EQ(inputNode.attributeStreams.size(), 1u);
+	EXPECT_EQ(inputNode.attributeStreams[0].offset, 3u);
+	EXPECT_EQ(inputNode.vertexElementOffset[(size_t)VertexElementType::VET_NORMAL], 3);
+
+	float* input = (float*)inputNode.vertexData->ptr(0);
+	for (size_t i = 0; i < 6; i++) {
+		EXPECT_EQ(input[i * 6], positions[i * 3]);
+		input[i * 6 + 3] = -1.f;
+	}
+
+	PrimitiveAfterVS::Node node;
+	VertexShader::processNode(&device, inputNode, 0, node);
+	CullStatistics statistics;
+	PrimitiveAssembler::processNode(targetWidth, targetHeight, node, statistics);
+	EXPECT_EQ(statistics.backFace, 1u);
+	VertexShader::processAttributeNode(node);
+
+	//normals of the visible triangle only
+	for (size_t i = 0; i < 6; i++) {
+		EXPECT_EQ(input[i * 6 + 3], i < 3 ? normals[i * 3] : -1.f);
+	}
+}
@@ -411,3 +411,22 @@ TEST(Rasterizer, Delaunay)
 	EXPECT_TRUE(canvas.checkResult(true));
 }
 
+
+//-------------------------------------------------------------------------------------
+TEST(Rasterizer, Barycentric)
+{
+	const int32_t canvasWidth = 64, canvasHeight = 64;
+
+	//z is invZ, so the barycentric coordinate is perspective-corrected
+	const fVector3 v0(4.f, 8.f, 1.f), v1(56.f, 40.f, 0.5f), v2(40.f, 8.f, 0.25f);
+
+	size_t pixelCounts = 0;
+	Rasterizer::drawTriangleLarrabee(canvasWidth, canvasHeight, v0, v1, v2, [&](const std::pair<int32_t, int32_t>& dot, const fVector3& percent) {
+		fVector3 t = Rasterizer::barycentric(v0, v1, v2, dot.first, dot.second);
+		EXPECT_EQ(percent.x, t.x);
+		EXPECT_EQ(percent.y, t.y);
+		EXPECT_EQ(percent.z, t.z);
+		pixelCounts++;
+	});
+	EXPECT_GT(pixelCounts, 0u);
+}
@@ -0,0 +1,163 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+TEST(RenderGraph, Order)
+{
+	RenderGraph graph;
+	RenderGraph::SurfaceDesc desc = { 16, 16, PF_FLOAT32_R };
+
+	RenderGraph::ResourceHandle shadow = graph.createSurface("shadow", desc);
+	RenderGraph::ResourceHandle gbuffer = graph.createSurface("gbuffer", desc);
+	RenderGraph::ResourceHandle unused = graph.createSurface("unused", desc);
+	RenderGraph::ResourceHandle backBuffer = graph.importResource("back_buffer");
+
+	int32_t counter = 0;
+	int32_t shadowOrder = -1, gbufferOrder = -1, lightingOrder = -1;
+
+	graph.addPass("shadow", {}, { shadow }, [&](const RenderGraph&) { shadowOrder = counter++; });
+	graph.addPass("gbuffer", {}, { gbuffer }, [&](const RenderGraph&) { gbufferOrder = counter++; });
+	graph.addPass("debug", { gbuffer }, { unused }, [&](const RenderGraph&) { counter++; });
+	graph.addPass("lighting", { shadow, gbuffer }, { backBuffer }, [&](const RenderGraph&) { lightingOrder = counter++; });
+	graph.compile();
+
+	//shadow and gbuffer are independent, debug pass is culled
+	EXPECT_EQ(graph.getLevelCounts(), 2u);
+	EXPECT_EQ(graph.getPassLevel(0), 0);
+	EXPECT_EQ(graph.getPassLevel(1), 0);
+	EXPECT_EQ(graph.getPassLevel(2), -1);
+	EXPECT_EQ(graph.getPassLevel(3), 1);
+
+	graph.execute();
+	EXPECT_EQ(counter, 3);
+	//passes of one level run one by one in declaration order
+	EXPECT_EQ(shadowOrder, 0);
+	EXPECT_EQ(gbufferOrder, 1);
+	EXPECT_EQ(lightingOrder, 2);
+}
+
+//-------------------------------------------------------------------------------------
+TEST(RenderGraph, Aliasing)
+{
+	RenderGraph graph;
+	RenderGraph::SurfaceDesc desc = { 32, 32, PF_FLOAT32_R };
+	const int32_t pixelCounts = desc.width*desc.height;
+
+	//a -> b -> c -> result, c can reuse the memory of a
+	RenderGraph::ResourceHandle a = graph.createSurface("a", desc);
+	RenderGraph::ResourceHandle b = graph.createSurface("b", desc);
+	RenderGraph::ResourceHandle c = graph.createSurface("c", desc);
+	RenderGraph::ResourceHandle result = graph.importResource("result");
+
+	std::vector<float> output(pixelCounts, 0.f);
+
+	graph.addPass("fill", {}, { a }, [a, pixelCounts](const RenderGraph& g) {
+		float* pa = g.getSurface<float>(a);
+		for (int32_t i = 0; i < pixelCounts; i++) pa[i] = (float)i;
+	});
+	graph.addPass("add", { a }, { b }, [a, b, pixelCounts](const RenderGraph& g) {
+		const float* pa = g.getSurface<float>(a);
+		float* pb = g.getSurface<float>(b);
+		for (int32_t i = 0; i < pixelCounts; i++) pb[i] = pa[i] + 1.f;
+	});
+	graph.addPass("scale", { b }, { c }, [b, c, pixelCounts](const RenderGraph& g) {
+		const float* pb = g.getSurface<float>(b);
+		float* pc = g.getSurface<float>(c);
+		for (int32_t i = 0; i < pixelCounts; i++) pc[i] = pb[i] * 2.f;
+	});
+	graph.addPass("resolve", { c }, { result }, [c, pixelCounts, &output](const RenderGraph& g) {
+		const float* pc = g.getSurface<float>(c);
+		for (int32_t i = 0; i < pixelCounts; i++) output[i] = pc[i];
+	});
+	graph.compile();
+
+	size_t surfaceSize = (size_t)pixelCounts * sizeof(float);
+	EXPECT_EQ(graph.getRequestedMemorySize(), surfaceSize * 3);
+	EXPECT_EQ(graph.getTransientMemorySize(), surfaceSize * 2);
+
+	graph.execute();
+	for (int32_t i = 0; i < pixelCounts; i++) {
+		EXPECT_EQ(output[i], (float)(i + 1) * 2.f);
+	}
+
+	//memory is kept for next frame
+	graph.reset();
+	RenderGraph::ResourceHandle d = graph.createSurface("d", desc);
+	result = graph.importResource("result");
+	graph.addPass("fill", {}, { d }, [](const RenderGraph&) {});
+	graph.addPass("resolve", { d }, { result }, [](const RenderGraph&) {});
+	graph.compile();
+	EXPECT_EQ(graph.getTransientMemorySize(), surfaceSize * 2);
+}
+
+//-------------------------------------------------------------------------------------
+TEST(RenderGraph, TypedSurfaces)
+{
+	RenderGraph graph;
+	const int32_t width = 8, height = 8;
+
+	//gbuffer -> color -> tone_mapped -> result, tone_mapped reuses the memory of gbuffer
+	RenderGraph::ResourceHandle gbuffer = graph.createGBuffer("gbuffer", width, height);
+	RenderGraph::ResourceHandle color = graph.createRenderTarget("color", width, height);
+	RenderGraph::ResourceHandle toneMapped = graph.createSurface("tone_mapped", { width, height, PF_FLOAT32_RGBA });
+	RenderGraph::ResourceHandle result = graph.importResource("result");
+
+	std::vector<fVector4> output((size_t)(width*height));
+	bool cleared = true;
+
+	graph.addPass("geometry", {}, { gbuffer }, [gbuffer, &cleared](const RenderGraph& g) {
+		GBuffer& surface = g.getGBuffer(gbuffer);
+		for (int32_t y = 0; y < height; y++) {
+			for (int32_t x = 0; x < width; x++) {
+				cleared = cleared && surface.isEmpty(x, y);
+
+				GBufferPixel pixel;
+				pixel.normal = fVector3::UNIT_Y;
+				pixel.albedo = fVector4((float)x, (float)y, 0.f, 1.f);
+				surface.setPixel(x, y, pixel, 0.5f);
+			}
+		}
+	});
+	graph.addPass("lighting", { gbuffer }, { color }, [gbuffer, color, &cleared](const RenderGraph& g) {
+		const GBuffer& input = g.getGBuffer(gbuffer);
+		RenderTarget& target = g.getRenderTarget(color);
+		for (int32_t y = 0; y < height; y++) {
+			for (int32_t x = 0; x < width; x++) {
+				cleared = cleared && target.earlyTest(x, y, 1.f);
+				target.setPixel(x, y, input.getAlbedoBuffer().getPixel(x, y), input.getDepthBuffer().getPixel(x, y));
+			}
+		}
+	});
+	graph.addPass("tone_map", { color }, { toneMapped }, [color, toneMapped](const RenderGraph& g) {
+		const PixelBuffer<fVector4>& input = g.getRenderTarget(color).getColorBuffer();
+		PixelBuffer<fVector4>& surface = g.getPixelBuffer<fVector4>(toneMapped);
+		for (int32_t y = 0; y < height; y++) {
+			for (int32_t x = 0; x < width; x++) {
+				surface.setPixel(x, y, input.getPixel(x, y) * 0.5f);
+			}
+		}
+	});
+	graph.addPass("resolve", { toneMapped }, { result }, [toneMapped, &output](const RenderGraph& g) {
+		const fVector4* pixels = g.getSurface<fVector4>(toneMapped);
+		std::copy(pixels, pixels + output.size(), output.begin());
+	});
+	graph.compile();
+
+	size_t gbufferSize = GBuffer::getMemorySize(width, height);
+	size_t colorSize = RenderTarget::getMemorySize(width, height);
+	EXPECT_EQ(graph.getRequestedMemorySize(), gbufferSize + colorSize + PixelBuffer<fVector4>::getMemorySize(width, height));
+	EXPECT_EQ(graph.getTransientMemorySize(), gbufferSize + colorSize);
+
+	graph.execute();
+	EXPECT_TRUE(cleared);
+	for (int32_t y = 0; y < height; y++) {
+		for (int32_t x = 0; x < width; x++) {
+			const fVector4& pixel = output[(size_t)(y*width + x)];
+			EXPECT_EQ(pixel.x, (float)x * 0.5f);
+			EXPECT_EQ(pixel.y, (float)y * 0.5f);
+			EXPECT_EQ(pixel.w, 0.5f);
+		}
+	}
+}
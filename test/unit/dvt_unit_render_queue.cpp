@@ -0,0 +1,56 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+class EmptyRenderable : public Renderable
+{
+public:
+	virtual size_t getVertexStreamCounts(void) const { return 0; }
+	virtual ConstVertexBufferPtr getVertexStream(size_t index) const { return nullptr; }
+	virtual ConstIndexBufferPtr getIndexBuffer(void) const { return nullptr; }
+};
+
+//-------------------------------------------------------------------------------------
+TEST(RenderQueue, AddRemove)
+{
+	std::vector<RenderablePtr> renderables;
+	for (size_t i = 0; i < 4; i++) {
+		renderables.push_back(std::make_shared<EmptyRenderable>());
+	}
+
+	std::unique_ptr<RenderQueue> queue(new RenderQueue());
+	for (RenderablePtr renderable : renderables) {
+		queue->pushRenderable(renderable);
+		EXPECT_EQ(renderable->getQueue(), queue.get());
+	}
+
+	//remove from the middle, the others are still found by their slots
+	queue->removeRenderable(renderables[1]);
+	queue->removeRenderable(renderables[1]);
+	queue->removeRenderable(renderables[3]);
+	EXPECT_EQ(renderables[1]->getQueue(), nullptr);
+
+	std::vector<ConstRenderablePtr> remain;
+	queue->visitorRenderable([&remain](ConstRenderablePtr renderable) { remain.push_back(renderable); });
+	ASSERT_EQ(remain.size(), 2u);
+	EXPECT_TRUE(std::find(remain.begin(), remain.end(), renderables[0]) != remain.end());
+	EXPECT_TRUE(std::find(remain.begin(), remain.end(), renderables[2]) != remain.end());
+
+	queue->removeRenderable(renderables[2]);
+	queue->removeRenderable(renderables[0]);
+	remain.clear();
+	queue->visitorRenderable([&remain](ConstRenderablePtr renderable) { remain.push_back(renderable); });
+	EXPECT_TRUE(remain.empty());
+
+	//clear and destroy detach the renderables
+	queue->pushRenderable(renderables[0]);
+	queue->pushRenderable(renderables[1]);
+	queue->clear();
+	EXPECT_EQ(renderables[0]->getQueue(), nullptr);
+
+	queue->pushRenderable(renderables[2]);
+	queue.reset();
+	EXPECT_EQ(renderables[2]->getQueue(), nullptr);
+}
@@ -0,0 +1,50 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+TEST(RenderTargetSet, Format)
+{
+	RenderTargetSet targets;
+	targets.init(4, 4, { PF_FLOAT32_RGBA, PF_UINT8_RGBA, PF_UINT32_R, PF_FLOAT32_RG });
+	ASSERT_EQ(targets.getTargetCounts(), 4);
+	EXPECT_EQ(RenderTargetSet::getPixelSize(PF_FLOAT32_RGBA), 16u);
+	EXPECT_EQ(RenderTargetSet::getPixelSize(PF_FLOAT32_RGB), 12u);
+	EXPECT_EQ(RenderTargetSet::getPixelSize(PF_FLOAT32_RG), 8u);
+	EXPECT_EQ(RenderTargetSet::getPixelSize(PF_FLOAT32_R), 4u);
+	EXPECT_EQ(RenderTargetSet::getPixelSize(PF_UINT8_RGBA), 4u);
+	EXPECT_EQ(RenderTargetSet::getPixelSize(PF_UINT32_R), 4u);
+
+	const fVector4 outputs[RenderTargetSet::MAX_TARGET_COUNTS] = {
+		fVector4(0.25f, -1.f, 2.f, 0.5f),
+		fVector4(-1.f, 0.5f, 2.f, 1.f),
+		fVector4(42.9f, 1.f, 1.f, 1.f),
+		fVector4(3.f, 4.f, 5.f, 6.f),
+	};
+	targets.setPixel(1, 2, outputs, 0.5f);
+
+	//float targets keep the value, other channels read as 0
+	EXPECT_EQ(targets.getPixel(0, 1, 2), outputs[0]);
+	EXPECT_EQ(targets.getPixel(3, 1, 2), fVector4(3.f, 4.f, 0.f, 0.f));
+
+	//8-bit target is saturated and packed as RGBA, red in the lowest byte
+	uint32_t packed;
+	memcpy(&packed, targets.ptr(1) + (2 * 4 + 1) * 4, sizeof(packed));
+	EXPECT_EQ(packed, 0xFFFF8000u);
+	EXPECT_EQ(targets.getPixel(1, 1, 2), fVector4(0.f, 128.f / 255.f, 1.f, 1.f));
+
+	//integer target takes x
+	EXPECT_EQ(targets.getPixel(2, 1, 2), fVector4(42.f, 0.f, 0.f, 0.f));
+
+	//depth test is shared by all targets
+	const fVector4 behind[RenderTargetSet::MAX_TARGET_COUNTS] = { fVector4::WHITE, fVector4::WHITE, fVector4::WHITE, fVector4::WHITE };
+	EXPECT_FALSE(targets.earlyTest(1, 2, 0.75f));
+	targets.setPixel(1, 2, behind, 0.75f);
+	EXPECT_EQ(targets.getPixel(0, 1, 2), outputs[0]);
+	EXPECT_EQ(targets.getPixel(2, 1, 2), fVector4(42.f, 0.f, 0.f, 0.f));
+	EXPECT_EQ(targets.getDepthBuffer().getPixel(1, 2), 0.5f);
+
+	//untouched pixels stay cleared
+	EXPECT_EQ(targets.getPixel(1, 0, 0), fVector4(0.f, 0.f, 0.f, 0.f));
+}
@@ -0,0 +1,144 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+class PassThroughVS : public VertexShader
+{
+public:
+	virtual void preRender(const fMatrix4& worldTransform, RenderablePtr renderable) const {}
+	virtual void vsFunction(const ConstantBuffer* constantBuffer, const float* input, const VertexDesc::OffsetData& inputVertexOffset, float* output, float& invZ) const {
+		output[0] = input[0];
+		output[1] = input[1];
+		output[2] = input[2];
+		invZ = 1.f;
+	}
+	virtual const VertexDesc& getOutputVertexDesc(void) const { return m_desc; }
+
+	VertexDesc m_desc;
+
+	PassThroughVS() { m_desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3); }
+};
+
+//-------------------------------------------------------------------------------------
+//every invocation outputs its own color, so pixels with the same color come from one invocation
+class CountingPS : public PixelShader
+{
+public:
+	virtual void preRender(RenderablePtr renderable) const {}
+	virtual void psFunction(const ConstantBuffer* constantBuffer, const float* input, fVector4& color, float& depth) const {
+		color = fVector4((float)(m_invocations++), 0.f, 0.f, 1.f);
+		depth = input[2];
+	}
+
+	mutable std::atomic<uint32_t> m_invocations;
+
+	CountingPS() : m_invocations(0) {}
+};
+
+//-------------------------------------------------------------------------------------
+//one clockwise triangle covering the whole screen
+class FullScreenTriangle : public Renderable
+{
+public:
+	virtual size_t getVertexStreamCounts(void) const { return 1; }
+	virtual ConstVertexBufferPtr getVertexStream(size_t index) const { return m_vertexBuffer; }
+	virtual ConstIndexBufferPtr getIndexBuffer(void) const { return m_indexBuffer; }
+
+	VertexBufferPtr m_vertexBuffer;
+	IndexBufferPtr m_indexBuffer;
+
+	FullScreenTriangle(RenderDevice* device, ConstVertexShaderPtr vs, ConstPixelShaderPtr ps) {
+		m_primitiveType = PT_TRIANGLE_LIST;
+		m_vs = vs;
+		m_ps = ps;
+		m_vsConstantBuffer = std::make_shared<ConstantBuffer>(device);
+		m_psConstantBuffer = std::make_shared<ConstantBuffer>(device);
+
+		VertexDesc desc;
+		desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3);
+		float vertices[] = { -1.f, -1.f, 0.5f, -1.f, 3.f, 0.5f, 3.f, -1.f, 0.5f };
+		m_vertexBuffer = std::make_shared<VertexBuffer>();
+		m_vertexBuffer->build(device, desc, vertices, 3);
+
+		uint16_t indices[] = { 0, 1, 2 };
+		m_indexBuffer = std::make_shared<IndexBuffer>();
+		m_indexBuffer->build(device, indices, 3);
+	}
+};
+
+//-------------------------------------------------------------------------------------
+//each size x size block of pixels has one color, and no two blocks share it
+static void _expectBlocks(const RenderTarget& target, int32_t x0, int32_t x1, int32_t size, std::set<float>& colors)
+{
+	for (int32_t y = 0; y < target.getHeight(); y += size) {
+		for (int32_t x = x0; x < x1; x += size) {
+			const fVector4& color = target.getColorBuffer().getPixel(x, y);
+			EXPECT_TRUE(colors.insert(color.x).second);
+
+			for (int32_t i = 0; i < size*size; i++) {
+				EXPECT_EQ(target.getColorBuffer().getPixel(x + i % size, y + i / size), color);
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+TEST(ShadingRate, CoarsePixels)
+{
+	enum { SIZE = 64 };
+
+	RenderDevice device;
+	std::shared_ptr<CountingPS> ps = std::make_shared<CountingPS>();
+	std::shared_ptr<FullScreenTriangle> renderable = std::make_shared<FullScreenTriangle>(&device, std::make_shared<PassThroughVS>(), ps);
+
+	RenderQueue queue;
+	queue.setDevice(&device);
+	queue.pushRenderable(renderable);
+
+	//rate of draw, every coarse pixel is shaded once and broadcast to all its pixels
+	const ShadingRate rates[] = { SR_1X1, SR_2X2, SR_4X4 };
+	for (ShadingRate rate : rates) {
+		renderable->setShadingRate(rate);
+		ps->m_invocations = 0;
+
+		RenderTarget target;
+		target.init(SIZE, SIZE);
+		queue.process(target);
+
+		int32_t size = 1 << rate;
+		EXPECT_EQ(ps->m_invocations, (uint32_t)((SIZE / size)*(SIZE / size)));
+
+		std::set<float> colors;
+		_expectBlocks(target, 0, SIZE, size, colors);
+	}
+
+	//rate of screen, full rate on the left half and 4x4 on the right
+	{
+		renderable->setShadingRate(SR_1X1);
+		ps->m_invocations = 0;
+
+		ShadingRateImage shadingRateImage;
+		shadingRateImage.init(SIZE, SIZE);
+		for (int32_t y = 0; y < shadingRateImage.getHeight(); y++) {
+			for (int32_t x = shadingRateImage.getWidth() / 2; x < shadingRateImage.getWidth(); x++) {
+				shadingRateImage.setPixel(x, y, SR_4X4);
+			}
+		}
+
+		RenderTarget target;
+		target.init(SIZE, SIZE);
+		target.setShadingRateImage(&shadingRateImage);
+		queue.process(target);
+
+		EXPECT_EQ(ps->m_invocations, (uint32_t)(SIZE / 2 * SIZE + (SIZE / 8)*(SIZE / 4)));
+
+		std::set<float> colors;
+		_expectBlocks(target, 0, SIZE / 2, 1, colors);
+		_expectBlocks(target, SIZE / 2, SIZE, 4, colors);
+	}
+}
@@ -0,0 +1,58 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+static Light _pointLight(const fVector3& position, float range)
+{
+	Light light;
+	light.type = Light::LT_POINT;
+	light.position = position;
+	light.color = fVector3::WHITE;
+	light.range = range;
+	light.direction = fVector3::UNIT_Z;
+	light.cosInnerCone = light.cosOuterCone = 0.f;
+	return light;
+}
+
+//-------------------------------------------------------------------------------------
+TEST(LightGrid, Binning)
+{
+	//2x2 tiles, identity view-projection so world position is NDC. 
+	//geometry at depth 0.5, except the top-right tile which is empty
+	PixelBuffer<float> depthBuffer;
+	depthBuffer.init(LightGrid::TILE_SIZE * 2, LightGrid::TILE_SIZE * 2, 0.5f);
+	for (int32_t y = LightGrid::TILE_SIZE; y < LightGrid::TILE_SIZE * 2; y++) {
+		for (int32_t x = LightGrid::TILE_SIZE; x < LightGrid::TILE_SIZE * 2; x++) {
+			depthBuffer.setPixel(x, y, std::numeric_limits<float>::max());
+		}
+	}
+
+	std::vector<Light> lights;
+	lights.push_back(_pointLight(fVector3(-0.5f, -0.5f, 0.5f), 0.2f));	//0: bottom-left tile
+	lights.push_back(_pointLight(fVector3(0.5f, -0.5f, 0.5f), 0.2f));	//1: bottom-right tile
+	lights.push_back(_pointLight(fVector3(0.f, 0.f, 0.5f), 0.2f));		//2: corner of all tiles
+	lights.push_back(_pointLight(fVector3(-0.5f, -0.5f, 0.9f), 0.2f));	//3: behind the geometry
+
+	//4: spot light in the top-left tile, looking at the geometry
+	Light spot = _pointLight(fVector3(-0.5f, 0.5f, 0.3f), 0.4f);
+	spot.type = Light::LT_SPOT;
+	spot.cosInnerCone = MathUtil::cos(MathUtil::PI / 8.f);
+	spot.cosOuterCone = MathUtil::cos(MathUtil::PI / 6.f);
+	lights.push_back(spot);
+
+	LightGrid grid;
+	grid.build(depthBuffer, fMatrix4::IDENTITY, lights);
+
+	const int32_t inner = LightGrid::TILE_SIZE / 2, outer = LightGrid::TILE_SIZE + LightGrid::TILE_SIZE / 2;
+	EXPECT_EQ(grid.getTileLights(inner, inner), std::vector<uint32_t>({ 0, 2 }));
+	EXPECT_EQ(grid.getTileLights(outer, inner), std::vector<uint32_t>({ 1, 2 }));
+	EXPECT_EQ(grid.getTileLights(inner, outer), std::vector<uint32_t>({ 2, 4 }));
+	EXPECT_TRUE(grid.getTileLights(outer, outer).empty());
+
+	//every pixel of a tile shares its list, NDC lookup lands in the same tile
+	EXPECT_EQ(&grid.getTileLights(0, 0), &grid.getTileLights(LightGrid::TILE_SIZE - 1, LightGrid::TILE_SIZE - 1));
+	EXPECT_EQ(&grid.getTileLights(fVector3(-0.5f, -0.5f, 0.5f)), &grid.getTileLights(inner, inner));
+	EXPECT_EQ(&grid.getTileLights(fVector3(0.5f, 0.5f, 0.5f)), &grid.getTileLights(outer, outer));
+}
@@ -0,0 +1,59 @@
+#include <davinci.h>
+#include <gtest/gtest.h>
+
+using namespace davinci;
+
+//-------------------------------------------------------------------------------------
+TEST(VertexBuffer, Dynamic)
+{
+	RenderDevice device;
+	VertexDesc desc;
+	desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3);
+
+	VertexBuffer vertexBuffer;
+	vertexBuffer.buildDynamic(&device, desc, 4);
+	EXPECT_TRUE(vertexBuffer.isDynamic());
+	EXPECT_EQ(vertexBuffer.counts(), 4u);
+
+	for (int32_t frame = 1; frame <= 3; frame++) {
+		float* vertices = vertexBuffer.map();
+		//pipeline still reads the last frame while writing
+		EXPECT_NE(vertices, vertexBuffer.ptr(0));
+		for (size_t i = 0; i < 4 * 3; i++) vertices[i] = (float)frame;
+		EXPECT_EQ(vertexBuffer.ptr(3)[2], (float)(frame - 1));
+		vertexBuffer.unmap();
+
+		EXPECT_EQ(vertexBuffer.ptr(0)[0], (float)frame);
+		EXPECT_EQ(vertexBuffer.ptr(3)[2], (float)frame);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+TEST(VertexBuffer, Wrap)
+{
+	RenderDevice device;
+	VertexDesc desc;
+	desc.addElement(VertexElementType::VET_POSITION, VertexElementFormat::VET_FLOAT_X3);
+
+	float vertices[] = { 0.f, 1.f, 2.f, 3.f, 4.f, 5.f };
+	{
+		VertexBuffer vertexBuffer;
+		vertexBuffer.wrap(&device, desc, vertices, 2);
+		EXPECT_FALSE(vertexBuffer.isDynamic());
+		EXPECT_EQ(vertexBuffer.ptr(1), vertices + 3);
+
+		//writes of the owner are seen without copy
+		vertices[4] = 10.f;
+		EXPECT_EQ(vertexBuffer.ptr(1)[1], 10.f);
+	}
+	//memory is still owned by caller
+	EXPECT_EQ(vertices[5], 5.f);
+
+	uint16_t indices[] = { 0, 1, 1 };
+	IndexBuffer indexBuffer;
+	indexBuffer.wrap(&device, indices, 3);
+	((uint16_t*)indexBuffer.map())[2] = 0;
+	indexBuffer.unmap();
+	EXPECT_EQ(indices[2], 0);
+	EXPECT_EQ(indexBuffer.get(2), 0);
+}